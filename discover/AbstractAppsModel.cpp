@@ -14,6 +14,7 @@
 #include <QFile>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QPointer>
 #include <QStandardPaths>
 #include <QtGlobal>
 
@@ -26,7 +27,7 @@ class BestInResultsStream : public QObject
 {
     Q_OBJECT
 public:
-    BestInResultsStream(const QSet<ResultsStream *> &streams)
+    BestInResultsStream(const QHash<ResultsStream *, QUrl> &streams)
         : QObject()
     {
         connect(this, &BestInResultsStream::finished, this, &QObject::deleteLater);
@@ -35,12 +36,15 @@ public:
             QTimer::singleShot(0, this, &BestInResultsStream::clear);
         }
 
-        for (auto stream : streams) {
-            m_streams.insert(stream);
-            connect(stream, &ResultsStream::resourcesFound, this, [this](const QVector<StreamResult> &resources) {
-                m_resources.append(resources.constFirst());
+        for (auto it = streams.constBegin(); it != streams.constEnd(); ++it) {
+            const QUrl uri = it.value();
+            m_streams.insert(it.key());
+            connect(it.key(), &ResultsStream::resourcesFound, this, [this, uri](const QVector<StreamResult> &resources) {
+                if (!m_resources.contains(uri)) {
+                    m_resources.insert(uri, resources.constFirst().resource);
+                }
             });
-            connect(stream, &QObject::destroyed, this, &BestInResultsStream::streamDestruction);
+            connect(it.key(), &QObject::destroyed, this, &BestInResultsStream::streamDestruction);
         }
     }
 
@@ -58,13 +62,88 @@ public:
     }
 
 Q_SIGNALS:
-    void finished(QVector<StreamResult> resources);
+    void finished(const QHash<QUrl, AbstractResource *> &resources);
 
 private:
-    QVector<StreamResult> m_resources;
+    QHash<QUrl, AbstractResource *> m_resources;
     QSet<QObject *> m_streams;
 };
 
+/**
+ * Remembers what each URI resolved to in the current application backend, so
+ * home page models created later don't need to search for them again.
+ *
+ * Dropped when the backends change. URIs that didn't resolve are forgotten
+ * whenever the backend contents change, e.g. after the AppStream data reloaded.
+ */
+class ResolvedUrisCache : public QObject
+{
+public:
+    static ResolvedUrisCache *global()
+    {
+        static ResolvedUrisCache s_cache;
+        return &s_cache;
+    }
+
+    /// @returns whether @p uri was resolved already, @p resource is null if nothing was found
+    bool lookup(AbstractResourcesBackend *backend, const QUrl &uri, AbstractResource **resource) const
+    {
+        if (backend != m_backend) {
+            return false;
+        }
+        const auto it = m_entries.constFind(uri);
+        if (it == m_entries.constEnd() || (it->found && !it->resource)) {
+            return false;
+        }
+        *resource = it->resource;
+        return true;
+    }
+
+    void insert(AbstractResourcesBackend *backend, const QUrl &uri, AbstractResource *resource)
+    {
+        if (backend != m_backend) {
+            if (m_backend) {
+                disconnect(m_backend, nullptr, this, nullptr);
+            }
+            m_entries.clear();
+            m_backend = backend;
+            connect(backend, &AbstractResourcesBackend::contentsChanged, this, &ResolvedUrisCache::forgetUnresolved);
+            connect(backend, &AbstractResourcesBackend::resourceRemoved, this, &ResolvedUrisCache::forget);
+        }
+        m_entries.insert(uri, {resource, resource != nullptr});
+    }
+
+private:
+    struct Entry {
+        QPointer<AbstractResource> resource;
+        bool found = false;
+    };
+
+    ResolvedUrisCache()
+    {
+        connect(ResourcesModel::global(), &ResourcesModel::backendsChanged, this, [this] {
+            m_entries.clear();
+        });
+    }
+
+    void forget(AbstractResource *resource)
+    {
+        m_entries.removeIf([resource](QHash<QUrl, Entry>::iterator it) {
+            return it->resource == resource;
+        });
+    }
+
+    void forgetUnresolved()
+    {
+        m_entries.removeIf([](QHash<QUrl, Entry>::iterator it) {
+            return !it->found;
+        });
+    }
+
+    QPointer<AbstractResourcesBackend> m_backend;
+    QHash<QUrl, Entry> m_entries;
+};
+
 AbstractAppsModel::AbstractAppsModel()
 {
     connect(ResourcesModel::global(), &ResourcesModel::currentApplicationBackendChanged, this, &AbstractAppsModel::refreshCurrentApplicationBackend);
@@ -102,17 +181,51 @@ void AbstractAppsModel::setUris(const QVector<QUrl> &uris)
     }
     m_uris = uris;
 
-    QSet<ResultsStream *> streams;
+    // Only search for what we haven't resolved in this backend already
+    QHash<ResultsStream *, QUrl> streams;
     for (const auto &uri : uris) {
+        AbstractResource *resource = nullptr;
+        if (ResolvedUrisCache::global()->lookup(m_backend, uri, &resource)) {
+            continue;
+        }
         AbstractResourcesBackend::Filters filter;
         filter.resourceUrl = uri;
-        streams << m_backend->search(filter);
+        streams.insert(m_backend->search(filter), uri);
     }
-    if (!streams.isEmpty()) {
-        auto stream = new BestInResultsStream(streams);
-        acquireFetching(true);
-        connect(stream, &BestInResultsStream::finished, this, &AbstractAppsModel::setResources);
+
+    acquireFetching(true);
+    if (streams.isEmpty()) {
+        setResources(resolvedResources());
+        return;
+    }
+
+    auto stream = new BestInResultsStream(streams);
+    connect(stream, &BestInResultsStream::finished, this, [this, backend = m_backend, uris, searched = streams.values()](const QHash<QUrl, AbstractResource *> &found) {
+        if (backend == m_backend) {
+            for (const auto &uri : searched) {
+                ResolvedUrisCache::global()->insert(backend, uri, found.value(uri));
+            }
+        }
+
+        if (m_uris == uris) {
+            setResources(resolvedResources());
+        } else {
+            acquireFetching(false);
+        }
+    });
+}
+
+QVector<StreamResult> AbstractAppsModel::resolvedResources() const
+{
+    QVector<StreamResult> resources;
+    resources.reserve(m_uris.size());
+    for (const auto &uri : m_uris) {
+        AbstractResource *resource = nullptr;
+        if (ResolvedUrisCache::global()->lookup(m_backend, uri, &resource) && resource) {
+            resources << StreamResult(resource);
+        }
     }
+    return resources;
 }
 
 static void filterDupes(QVector<StreamResult> &resources)
@@ -148,7 +261,6 @@ void AbstractAppsModel::setResources(const QVector<StreamResult> &_resources)
     filterDupes(resources);
 
     if (m_resources != resources) {
-        // TODO: sort like in the json files
         beginResetModel();
         m_resources = resources;
         endResetModel();
@@ -46,6 +46,8 @@ Q_SIGNALS:
 protected:
     void refreshCurrentApplicationBackend();
     void setUris(const QVector<QUrl> &uris);
+    /// Resources for the current URIs that are known already, in the same order
+    QVector<StreamResult> resolvedResources() const;
     void removeResource(AbstractResource *resource);
 
     void acquireFetching(bool f);
@@ -30,7 +30,6 @@
 #include <QQmlEngine>
 #include <QSessionManager>
 #include <QTimer>
-#include <QtQuick/QQuickItem>
 #include <qqml.h>
 
 // KDE includes
@@ -317,13 +316,6 @@ void DiscoverObject::openCategory(const QString &category)
     }
 }
 
-void DiscoverObject::startHeadlessUpdate()
-{
-    openMode(u"update"_s);
-    QQuickItem *updatesPage = m_mainWindow->property("leftPage").value<QQuickItem *>();
-    updatesPage->setProperty("startHeadlessUpdate", true);
-}
-
 void DiscoverObject::openLocalPackage(const QUrl &localfile)
 {
     if (!QFile::exists(localfile.toLocalFile())) {
@@ -64,7 +64,6 @@ public Q_SLOTS:
     void openCategory(const QString &category);
     void openMode(const QString &mode);
     void openLocalPackage(const QUrl &localfile);
-    void startHeadlessUpdate();
 
     void promptReboot();
     void rebootNow();
@@ -10,8 +10,10 @@
 #include <KConfigGroup>
 #include <KIO/StoredTransferJob>
 #include <KSharedConfig>
+#include <QDateTime>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QStandardPaths>
@@ -84,6 +86,18 @@ void FeaturedModel::refresh()
     const auto dest = qScopeGuard([this] {
         acquireFetching(false);
     });
+
+    // The file only changes when a new listing is downloaded, don't parse it
+    // again for every refresh and every model instance
+    static QDateTime s_lastModified;
+    static qint64 s_size = -1;
+    static QVector<QUrl> s_uris;
+    const QFileInfo info(*featuredCache);
+    if (info.exists() && info.lastModified() == s_lastModified && info.size() == s_size) {
+        setUris(s_uris);
+        return;
+    }
+
     QFile f(*featuredCache);
     if (!f.open(QIODevice::ReadOnly)) {
         qCWarning(DISCOVER_LOG) << "couldn't open file" << *featuredCache << f.errorString();
@@ -96,10 +110,12 @@ void FeaturedModel::refresh()
         return;
     }
 
-    const auto uris = kTransform<QVector<QUrl>>(array, [](const QJsonValue &uri) {
+    s_uris = kTransform<QVector<QUrl>>(array, [](const QJsonValue &uri) {
         return QUrl(uri.toString());
     });
-    setUris(uris);
+    s_lastModified = info.lastModified();
+    s_size = info.size();
+    setUris(s_uris);
 }
 
 #include "moc_FeaturedModel.cpp"
@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+// SPDX-FileCopyrightText: 2026 Plasma Discover contributors
+
+#include "HeadlessUpdater.h"
+#include "PowerManagementInterface.h"
+#include "RefreshNotifier.h"
+#include "discover_debug.h"
+
+#include <KLocalizedString>
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMetaEnum>
+#include <QTimer>
+#include <Transaction/Transaction.h>
+#include <resources/AbstractBackendUpdater.h>
+#include <resources/AbstractResource.h>
+#include <resources/ResourcesModel.h>
+#include <resources/ResourcesUpdatesModel.h>
+#include <utils.h>
+
+using namespace Qt::StringLiterals;
+
+HeadlessUpdater::HeadlessUpdater(QObject *parent)
+    : QObject(parent)
+    , m_model(new ResourcesUpdatesModel(this))
+    , m_powerManagement(new PowerManagementInterface(this))
+    , m_output(stdout)
+{
+    new RefreshNotifier(this);
+    m_powerManagement->setReason(i18n("Updating software"));
+
+    connect(ResourcesModel::global(), &ResourcesModel::fetchingUpdatesProgressChanged, this, &HeadlessUpdater::considerStarting);
+    connect(m_model, &ResourcesUpdatesModel::fetchingChanged, this, &HeadlessUpdater::considerStarting);
+    connect(m_model, &ResourcesUpdatesModel::progressingChanged, this, &HeadlessUpdater::considerStarting);
+    connect(m_model, &ResourcesUpdatesModel::finished, this, &HeadlessUpdater::finished);
+    connect(m_model, &ResourcesUpdatesModel::passiveMessage, this, [this](const QString &message) {
+        report("message"_L1, {{u"message"_s, message}});
+    });
+    connect(m_model, &ResourcesUpdatesModel::resourceProgressed, this, [this](AbstractResource *resource, qreal progress, AbstractBackendUpdater::State state) {
+        report("resource"_L1,
+               {
+                   {u"resource"_s, resource->packageName()},
+                   {u"progress"_s, qRound(progress)},
+                   {u"state"_s, QString::fromLatin1(QMetaEnum::fromType<AbstractBackendUpdater::State>().valueToKey(state))},
+               });
+    });
+
+    report("fetching"_L1);
+    // The backends only start fetching once the event loop runs
+    QTimer::singleShot(0, this, &HeadlessUpdater::considerStarting);
+}
+
+void HeadlessUpdater::considerStarting()
+{
+    // The updaters only report fetching while they check for updates, the backends
+    // may still be loading before that. Every one of them needs to be done first.
+    if (m_started || ResourcesModel::global()->fetchingUpdatesProgress() < 100 || m_model->isFetching() || m_model->isProgressing()) {
+        return;
+    }
+
+    const QStringList errors = m_model->errorMessages();
+    if (!errors.isEmpty()) {
+        qCWarning(DISCOVER_LOG) << "Unable to start update" << errors;
+        report("error"_L1, {{u"messages"_s, QJsonArray::fromStringList(errors)}});
+        exit(CannotUpdate);
+        return;
+    }
+
+    m_model->prepare();
+    const bool hasUpdates = kContains(m_model->updaters(), [](AbstractBackendUpdater *updater) {
+        return updater->hasUpdates();
+    });
+    if (!hasUpdates) {
+        report("done"_L1, {{u"updated"_s, false}, {u"needsReboot"_s, m_model->needsReboot()}});
+        exit(Success);
+        return;
+    }
+
+    start();
+}
+
+void HeadlessUpdater::start()
+{
+    m_started = true;
+    report("started"_L1, {{u"updates"_s, m_model->toUpdate().count()}});
+
+    m_model->updateAll();
+    Transaction *transaction = m_model->transaction();
+    if (!transaction) {
+        exit(CannotUpdate);
+        return;
+    }
+
+    m_powerManagement->setPreventSleep(true);
+    connect(transaction, &Transaction::progressChanged, this, &HeadlessUpdater::progressChanged);
+    connect(transaction, &Transaction::statusChanged, this, &HeadlessUpdater::progressChanged);
+    connect(transaction, &Transaction::distroErrorMessage, this, [this](const QString &message) {
+        m_failed = true;
+        report("error"_L1, {{u"messages"_s, QJsonArray{message}}});
+    });
+    // Nobody is around to answer questions such as licence agreements, refuse them
+    connect(transaction, &Transaction::proceedRequest, this, [this, transaction](const QString &title, const QString &description) {
+        m_failed = true;
+        report("error"_L1, {{u"messages"_s, QJsonArray{title, description}}});
+        transaction->cancel();
+    });
+}
+
+void HeadlessUpdater::progressChanged()
+{
+    Transaction *transaction = m_model->transaction();
+    if (!transaction || transaction->progress() == m_lastProgress) {
+        return;
+    }
+    m_lastProgress = transaction->progress();
+    report("progress"_L1,
+           {
+               {u"progress"_s, m_lastProgress},
+               {u"status"_s, QString::fromLatin1(QMetaEnum::fromType<Transaction::Status>().valueToKey(transaction->status()))},
+               {u"downloadSpeed"_s, qint64(transaction->downloadSpeed())},
+           });
+}
+
+void HeadlessUpdater::finished()
+{
+    m_powerManagement->setPreventSleep(false);
+
+    const QStringList errors = m_model->errorMessages();
+    if (!errors.isEmpty()) {
+        m_failed = true;
+        report("error"_L1, {{u"messages"_s, QJsonArray::fromStringList(errors)}});
+    }
+
+    report("done"_L1, {{u"updated"_s, !m_failed}, {u"needsReboot"_s, m_model->needsReboot()}});
+    exit(m_failed ? UpdateFailed : Success);
+}
+
+void HeadlessUpdater::report(QLatin1StringView event, QJsonObject data)
+{
+    data.insert(u"event"_s, event);
+    m_output << QJsonDocument(data).toJson(QJsonDocument::Compact) << Qt::endl;
+}
+
+void HeadlessUpdater::exit(ExitCode code)
+{
+    m_started = true;
+    QTimer::singleShot(0, QCoreApplication::instance(), [code] {
+        QCoreApplication::exit(code);
+    });
+}
+
+#include "moc_HeadlessUpdater.cpp"
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+// SPDX-FileCopyrightText: 2026 Plasma Discover contributors
+
+#pragma once
+
+#include <QJsonObject>
+#include <QObject>
+#include <QTextStream>
+
+class PowerManagementInterface;
+class ResourcesUpdatesModel;
+
+// Runs the unattended updates from plain C++, without a QML engine or window.
+// Progress is reported on stdout as one JSON object per line, for example
+//   {"event":"progress","progress":42,"status":"DownloadingStatus"}
+// and the application exits with one of the ExitCode values once done.
+class HeadlessUpdater : public QObject
+{
+    Q_OBJECT
+public:
+    enum ExitCode {
+        Success = 0,
+        UpdateFailed = 1,
+        CannotUpdate = 2,
+    };
+    Q_ENUM(ExitCode)
+
+    explicit HeadlessUpdater(QObject *parent = nullptr);
+
+private:
+    void considerStarting();
+    void start();
+    void progressChanged();
+    void finished();
+    void report(QLatin1StringView event, QJsonObject data = {});
+    void exit(ExitCode code);
+
+    ResourcesUpdatesModel *const m_model;
+    PowerManagementInterface *const m_powerManagement;
+    QTextStream m_output;
+    bool m_started = false;
+    bool m_failed = false;
+    int m_lastProgress = -1;
+};
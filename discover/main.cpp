@@ -8,6 +8,7 @@
 
 #include "DiscoverObject.h"
 #include "DiscoverVersion.h"
+#include "HeadlessUpdater.h"
 #include <DiscoverBackendsFactory.h>
 #include <KAboutData>
 #include <KConfig>
@@ -69,10 +70,6 @@ void processArgs(QCommandLineParser *parser, DiscoverObject *discoverObject)
         discoverObject->openLocalPackage(QUrl::fromUserInput(parser->value(QStringLiteral("local-filename")), QDir::currentPath(), QUrl::AssumeLocalFile));
     }
 
-    if (parser->isSet(QStringLiteral("headless-update"))) {
-        discoverObject->startHeadlessUpdate();
-    }
-
     const auto positionalArguments = parser->positionalArguments();
     for (const QString &arg : positionalArguments) {
         const QUrl url = QUrl::fromUserInput(arg, QDir::currentPath(), QUrl::AssumeLocalFile);
@@ -173,6 +170,12 @@ int main(int argc, char **argv)
             QStandardPaths::setTestModeEnabled(true);
         }
 
+        if (headlessUpdate) {
+            // No window will ever be shown, so skip the QML engine altogether
+            new HeadlessUpdater(&app);
+            return app.exec();
+        }
+
         KDBusService *service = !feedback ? new KDBusService(KDBusService::Unique, &app) : nullptr;
 
         {
@@ -182,7 +185,7 @@ int main(int argc, char **argv)
             QVariantMap initialProperties;
             if (!options.isEmpty() || !parser->positionalArguments().isEmpty())
                 initialProperties = {{QStringLiteral("currentTopLevel"), QStringLiteral(DISCOVER_BASE_URL "/LoadingPage.qml")}};
-            if (feedback || headlessUpdate) {
+            if (feedback) {
                 initialProperties.insert(QStringLiteral("visible"), false);
             }
             discoverObject = new DiscoverObject(initialProperties);
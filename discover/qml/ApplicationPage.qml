@@ -322,6 +322,7 @@ DiscoverPage {
 
             carouselModel: Discover.ScreenshotsModel {
                 application: appInfo.application
+                currentIndex: carousel.currentIndex
             }
         }
 
@@ -16,7 +16,7 @@ ConditionalLoader {
     property bool hideInvokeButton: true
 
     readonly property alias isActive: listener.isActive
-    readonly property bool isStateAvailable: application.state !== Discover.AbstractResource.Broken
+    readonly property bool isStateAvailable: application.state !== Discover.AbstractResource.Broken && !application.isPlaceholder
     readonly property alias listener: listener
 
     Discover.TransactionListener {
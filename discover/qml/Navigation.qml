@@ -51,6 +51,10 @@ QtObject {
 
     function openApplication(application: Discover.AbstractResource) {
         console.assert(application)
+        // Restored from the last session, there's nothing to show until its backend has loaded
+        if (application.isPlaceholder) {
+            return
+        }
         window.pageStack.push(Qt.resolvedUrl("ApplicationPage.qml"), { application })
     }
 
@@ -136,26 +136,7 @@ DiscoverPage {
         backend: resourcesUpdatesModel
     }
 
-    property bool startHeadlessUpdate: false
-    function considerStartingHeadlessUpdate() {
-        if (!startHeadlessUpdate || !readyToUpdate) {
-            return;
-        }
-        if (updateAction.enabled) {
-            updateAction.trigger()
-            app.quitWhenIdle();
-            startHeadlessUpdate = false;
-        } else if (updateAction.hasErrors) {
-            console.warn("Unable to start update")
-            app.restore();
-            startHeadlessUpdate = false;
-        } else {
-            console.warn("Waiting for updates")
-        }
-    }
-    onStartHeadlessUpdateChanged: considerStartingHeadlessUpdate()
     readonly property bool readyToUpdate: !resourcesUpdatesModel.isProgressing && !resourcesUpdatesModel.isFetching
-    onReadyToUpdateChanged: considerStartingHeadlessUpdate()
     readonly property alias hasErrors: updateAction.hasErrors
     Kirigami.Action {
         id: updateAction
@@ -166,9 +147,6 @@ DiscoverPage {
         readonly property bool hasErrors: page.header.children.some(item => item?.visible && item instanceof Kirigami.InlineMessage && (item as Kirigami.InlineMessage).type === Kirigami.MessageType.Error)
 
         enabled: page.readyToUpdate && !hasErrors
-        onEnabledChanged: enabled => {
-            page.considerStartingHeadlessUpdate()
-        }
         onTriggered: resourcesUpdatesModel.updateAll()
     }
 
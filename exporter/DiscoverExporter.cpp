@@ -6,18 +6,41 @@
 
 #include "DiscoverExporter.h"
 #include <QDebug>
-#include <QFile>
-#include <QJsonArray>
+#include <QFuture>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QMetaProperty>
-#include <chrono>
+#include <QTimer>
+#include <QtConcurrentRun>
 #include <resources/AbstractResource.h>
 #include <resources/AbstractResourcesBackend.h>
 #include <resources/ResourcesModel.h>
-#include <resources/StoredResultsStream.h>
+#include <utility>
 
-using namespace std::chrono_literals;
+using namespace Qt::StringLiterals;
+
+namespace
+{
+// Resources serialized per thread pool task
+constexpr qsizetype s_batchSize = 256;
+
+// Always exported, they identify the resources when resuming
+const QSet<QByteArray> s_identifyingProperties = {"packageName", "origin", "appstreamId"};
+
+QString resumeKey(const QJsonObject &object)
+{
+    return object.value("packageName"_L1).toString() + u'\n' + object.value("origin"_L1).toString() + u'\n' + object.value("appstreamId"_L1).toString();
+}
+
+QByteArray serialize(const QList<QJsonObject> &objects)
+{
+    QByteArray ret;
+    for (const QJsonObject &object : objects) {
+        ret += QJsonDocument(object).toJson(QJsonDocument::Compact);
+        ret += '\n';
+    }
+    return ret;
+}
+} // namespace
 
 DiscoverExporter::DiscoverExporter()
     : QObject(nullptr)
@@ -33,59 +56,163 @@ void DiscoverExporter::setExportPath(const QUrl &url)
     m_path = url;
 }
 
-QJsonObject itemDataToMap(const AbstractResource *res, const QSet<QByteArray> &excluded)
+void DiscoverExporter::setProperties(const QStringList &properties)
 {
-    QJsonObject ret;
-    int propsCount = res->metaObject()->propertyCount();
-    for (int i = 0; i < propsCount; i++) {
-        QMetaProperty prop = res->metaObject()->property(i);
-        if (prop.userType() >= QMetaType::User || excluded.contains(prop.name()))
-            continue;
+    m_properties.clear();
+    for (const QString &property : properties) {
+        m_properties.insert(property.toLatin1());
+    }
+    m_metaProperties.clear();
+}
 
-        const QVariant val = prop.read(res);
-        if (val.isNull())
-            continue;
+void DiscoverExporter::setResume(bool resume)
+{
+    m_resume = resume;
+}
 
-        ret.insert(QLatin1String(prop.name()), QJsonValue::fromVariant(val));
+const QList<QMetaProperty> &DiscoverExporter::exportedProperties(const QMetaObject *metaObject)
+{
+    auto it = m_metaProperties.find(metaObject);
+    if (it == m_metaProperties.end()) {
+        QList<QMetaProperty> properties;
+        for (int i = 0, count = metaObject->propertyCount(); i < count; i++) {
+            const QMetaProperty prop = metaObject->property(i);
+            if (prop.userType() >= QMetaType::User || m_excludedProperties.contains(prop.name())) {
+                continue;
+            }
+            if (!m_properties.isEmpty() && !m_properties.contains(prop.name()) && !s_identifyingProperties.contains(prop.name())) {
+                continue;
+            }
+            properties += prop;
+        }
+        it = m_metaProperties.insert(metaObject, properties);
     }
-    return ret;
+    return *it;
+}
+
+bool DiscoverExporter::openExport()
+{
+    m_file.setFileName(m_path.toLocalFile());
+    if (!m_resume || !m_file.exists()) {
+        return m_file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    // Drop whatever was left half written when the previous export got interrupted
+    qint64 complete = 0;
+    while (!m_file.atEnd()) {
+        const QByteArray line = m_file.readLine();
+        if (!line.endsWith('\n')) {
+            break;
+        }
+        complete = m_file.pos();
+        const QJsonDocument doc = QJsonDocument::fromJson(line);
+        if (doc.isObject()) {
+            m_previouslyExported.insert(resumeKey(doc.object()));
+        }
+    }
+    m_file.resize(complete);
+    m_file.seek(complete);
+    qDebug() << "resuming export with" << m_previouslyExported.count() << "items from" << m_path;
+    return true;
 }
 
 void DiscoverExporter::fetchResources()
 {
-    ResourcesModel *m = ResourcesModel::global();
-    QSet<ResultsStream *> streams;
-    const auto backends = m->backends();
+    if (m_started) {
+        return;
+    }
+    m_started = true;
+
+    if (!openExport()) {
+        qWarning() << "Could not write to " << m_path << m_file.errorString();
+        QTimer::singleShot(0, this, &DiscoverExporter::exportDone);
+        return;
+    }
+
+    const auto backends = ResourcesModel::global()->backends();
     for (auto backend : backends) {
-        streams << backend->search({});
+        ResultsStream *stream = backend->search({});
+        ++m_pendingStreams;
+        connect(stream, &ResultsStream::resourcesFound, this, &DiscoverExporter::exportResources);
+        connect(stream, &QObject::destroyed, this, &DiscoverExporter::streamFinished);
     }
-    auto stream = new StoredResultsStream(streams);
-    connect(stream, &StoredResultsStream::finishedResources, this, &DiscoverExporter::exportResources);
-    QTimer::singleShot(15s, stream, &AggregatedResultsStream::finished);
+    QTimer::singleShot(0, this, &DiscoverExporter::finishIfDone);
 }
 
 void DiscoverExporter::exportResources(const QVector<StreamResult> &resources)
 {
-    QJsonArray data;
-    for (auto res : resources) {
-        data += itemDataToMap(res.resource, m_excludedProperties);
+    // Properties have to be read on the main thread, turning them into text doesn't
+    QList<QJsonObject> batch;
+    batch.reserve(std::min(resources.size(), s_batchSize));
+    const auto flush = [this, &batch] {
+        if (batch.isEmpty()) {
+            return;
+        }
+        ++m_pendingBatches;
+        QtConcurrent::run(serialize, std::exchange(batch, {})).then(this, [this](const QByteArray &lines) {
+            --m_pendingBatches;
+            writeLines(lines);
+            finishIfDone();
+        });
+    };
+
+    for (const auto &result : resources) {
+        AbstractResource *res = result.resource;
+        if (!res || m_exported.contains(res)) {
+            continue;
+        }
+        m_exported.insert(res);
+
+        QJsonObject object;
+        const auto &properties = exportedProperties(res->metaObject());
+        for (const QMetaProperty &prop : properties) {
+            const QVariant val = prop.read(res);
+            if (val.isNull()) {
+                continue;
+            }
+            object.insert(QLatin1String(prop.name()), QJsonValue::fromVariant(val));
+        }
+
+        if (!m_previouslyExported.isEmpty() && m_previouslyExported.contains(resumeKey(object))) {
+            continue;
+        }
+
+        batch += object;
+        if (batch.size() >= s_batchSize) {
+            flush();
+        }
+    }
+    flush();
+}
+
+void DiscoverExporter::writeLines(const QByteArray &lines)
+{
+    if (m_file.write(lines) != lines.size()) {
+        qWarning() << "Could not completely export the data to " << m_path << m_file.errorString();
     }
+    // Keep what's exported so far on disk, so an interrupted export can be resumed
+    m_file.flush();
+    m_count += lines.count('\n');
+}
+
+void DiscoverExporter::streamFinished()
+{
+    --m_pendingStreams;
+    finishIfDone();
+}
 
-    QJsonDocument doc = QJsonDocument(data);
-    if (doc.isNull()) {
-        qWarning() << "Could not completely export the data to " << m_path;
+void DiscoverExporter::finishIfDone()
+{
+    if (!m_file.isOpen() || m_pendingStreams > 0 || m_pendingBatches > 0) {
         return;
     }
 
-    QFile f(m_path.toLocalFile());
-    if (f.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        int w = f.write(doc.toJson(QJsonDocument::Indented));
-        if (w <= 0)
-            qWarning() << "Could not completely export the data to " << m_path;
-    } else {
-        qWarning() << "Could not write to " << m_path;
-    }
-    qDebug() << "exported items: " << data.count() << " to " << m_path;
+    m_file.close();
+    qDebug() << "exported items: " << m_count << " to " << m_path;
     Q_EMIT exportDone();
 }
 
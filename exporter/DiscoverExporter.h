@@ -6,12 +6,16 @@
 
 #pragma once
 
+#include <QFile>
+#include <QHash>
+#include <QMetaProperty>
 #include <QSet>
-#include <QTimer>
 #include <QUrl>
 
+class AbstractResource;
 struct StreamResult;
 
+/// Exports every resource as one JSON object per line (NDJSON), as the backends find them
 class DiscoverExporter : public QObject
 {
     Q_OBJECT
@@ -20,15 +24,35 @@ public:
     ~DiscoverExporter() override;
 
     void setExportPath(const QUrl &url);
+    /// Only exports @p properties, besides the ones identifying the resource. Exports all of them when empty.
+    void setProperties(const QStringList &properties);
+    /// Appends to an existing export, skipping the resources it already has
+    void setResume(bool resume);
 
 public Q_SLOTS:
     void fetchResources();
-    void exportResources(const QVector<StreamResult> &resources);
 
 Q_SIGNALS:
     void exportDone();
 
 private:
+    bool openExport();
+    void exportResources(const QVector<StreamResult> &resources);
+    void streamFinished();
+    void writeLines(const QByteArray &lines);
+    void finishIfDone();
+    const QList<QMetaProperty> &exportedProperties(const QMetaObject *metaObject);
+
     QUrl m_path;
+    QFile m_file;
     const QSet<QByteArray> m_excludedProperties;
+    QSet<QByteArray> m_properties;
+    QHash<const QMetaObject *, QList<QMetaProperty>> m_metaProperties;
+    QSet<AbstractResource *> m_exported;
+    QSet<QString> m_previouslyExported;
+    bool m_resume = false;
+    bool m_started = false;
+    int m_pendingStreams = 0;
+    int m_pendingBatches = 0;
+    qsizetype m_count = 0;
 };
@@ -33,6 +33,10 @@ int main(int argc, char **argv)
     {
         QCommandLineParser parser;
         parser.addPositionalArgument(QStringLiteral("file"), i18n("File to which we'll export"));
+        parser.addOption(QCommandLineOption(QStringLiteral("properties"),
+                                            i18n("Comma-separated list of the properties to export, all of them by default"),
+                                            QStringLiteral("names")));
+        parser.addOption(QCommandLineOption(QStringLiteral("resume"), i18n("Continue an interrupted export, keeping what it already wrote")));
         DiscoverBackendsFactory::setupCommandLine(&parser);
         about.setupCommandLine(&parser);
         parser.process(app);
@@ -43,6 +47,8 @@ int main(int argc, char **argv)
             parser.showHelp(1);
         }
         exp.setExportPath(QUrl::fromUserInput(parser.positionalArguments().at(0), QString(), QUrl::AssumeLocalFile));
+        exp.setProperties(parser.value(QStringLiteral("properties")).split(QLatin1Char(','), Qt::SkipEmptyParts));
+        exp.setResume(parser.isSet(QStringLiteral("resume")));
     }
 
     QObject::connect(&exp, &DiscoverExporter::exportDone, &app, &QCoreApplication::quit);
@@ -181,10 +181,23 @@ void ReviewsModel::fetchMore(const QModelIndex &parent)
     // qCDebug(LIBDISCOVER_LOG) << "fetching reviews... " << m_lastPage;
 }
 
-void ReviewsModel::addReviews(const QVector<ReviewPtr> &reviews, bool canFetchMore)
+void ReviewsModel::addReviews(const QVector<ReviewPtr> &_reviews, bool canFetchMore)
 {
-    m_canFetchMore = canFetchMore;
-    qCDebug(LIBDISCOVER_LOG) << "reviews arrived..." << m_lastPage << reviews.size();
+    qCDebug(LIBDISCOVER_LOG) << "reviews arrived..." << m_lastPage << _reviews.size();
+
+    // Don't list a review twice if the server ignored the page we asked for,
+    // and stop asking for more in that case
+    QVector<ReviewPtr> reviews;
+    reviews.reserve(_reviews.size());
+    for (const auto &review : _reviews) {
+        const bool known = std::any_of(m_reviews.constBegin(), m_reviews.constEnd(), [&review](const ReviewPtr &other) {
+            return other->id() != 0 && other->id() == review->id();
+        });
+        if (!known) {
+            reviews << review;
+        }
+    }
+    m_canFetchMore = canFetchMore && !reviews.isEmpty();
 
     if (!reviews.isEmpty()) {
         beginInsertRows(QModelIndex(), rowCount(), rowCount() + reviews.size() - 1);
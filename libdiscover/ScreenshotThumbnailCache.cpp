@@ -0,0 +1,230 @@
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+// SPDX-FileCopyrightText: 2026 Plasma Discover contributors
+
+#include "ScreenshotThumbnailCache.h"
+#include "libdiscover_debug.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+
+using namespace Qt::StringLiterals;
+
+namespace
+{
+constexpr int s_maxConcurrentDownloads = 4;
+constexpr qint64 s_maxCacheSize = 64 * 1024 * 1024;
+constexpr auto s_etagSuffix = ".etag"_L1;
+constexpr auto s_trimDelay = std::chrono::seconds(5);
+
+bool writeFile(const QString &path, const QByteArray &data)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qCWarning(LIBDISCOVER_LOG) << "Could not write screenshot thumbnail" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+// Stores the thumbnail as it was served unless it's larger than needed, in which case
+// it's downscaled and written back in the same format when Qt can encode it
+bool storeThumbnail(const QString &path, const QByteArray &data, const QByteArray &etag, const QSize &size)
+{
+    QBuffer buffer;
+    buffer.setData(data);
+    QImageReader reader(&buffer);
+    if (!reader.canRead()) {
+        qCDebug(LIBDISCOVER_LOG) << "Could not decode screenshot thumbnail" << reader.errorString();
+        return false;
+    }
+    const QSize imageSize = reader.size();
+
+    QByteArray stored = data;
+    if (size.isValid() && imageSize.isValid() && (imageSize.width() > size.width() || imageSize.height() > size.height())) {
+        const QByteArray format = reader.format();
+        reader.setScaledSize(imageSize.scaled(size, Qt::KeepAspectRatio));
+        const QImage image = reader.read();
+        if (image.isNull()) {
+            qCDebug(LIBDISCOVER_LOG) << "Could not decode screenshot thumbnail" << reader.errorString();
+            return false;
+        }
+
+        QBuffer scaled(&stored);
+        scaled.open(QIODevice::WriteOnly);
+        if (!image.save(&scaled, QImageWriter::supportedImageFormats().contains(format) ? format.constData() : "PNG")) {
+            return false;
+        }
+    }
+
+    if (!writeFile(path, stored)) {
+        return false;
+    }
+    if (etag.isEmpty()) {
+        QFile::remove(path + s_etagSuffix);
+        return true;
+    }
+    return writeFile(path + s_etagSuffix, etag);
+}
+
+// Drops the least recently used thumbnails until the cache fits its budget
+void trimCache(const QString &cacheDir)
+{
+    const auto entries = QDir(cacheDir).entryInfoList(QDir::Files, QDir::Time);
+    qint64 total = 0;
+    for (const QFileInfo &entry : entries) {
+        // ETags go along with their thumbnail
+        if (entry.fileName().endsWith(s_etagSuffix)) {
+            continue;
+        }
+        total += entry.size();
+        if (total > s_maxCacheSize) {
+            QFile::remove(entry.absoluteFilePath());
+            QFile::remove(entry.absoluteFilePath() + s_etagSuffix);
+        }
+    }
+}
+} // namespace
+
+ScreenshotThumbnailCache *ScreenshotThumbnailCache::instance()
+{
+    static ScreenshotThumbnailCache cache;
+    return &cache;
+}
+
+ScreenshotThumbnailCache::ScreenshotThumbnailCache()
+    : m_cacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/screenshots"_L1)
+{
+    QDir().mkpath(m_cacheDir);
+
+    // Writes come in bursts when a gallery is opened, trim once they settle
+    m_trimTimer.setSingleShot(true);
+    m_trimTimer.setInterval(s_trimDelay);
+    connect(&m_trimTimer, &QTimer::timeout, this, [cacheDir = m_cacheDir] {
+        QThreadPool::globalInstance()->start([cacheDir] {
+            trimCache(cacheDir);
+        });
+    });
+    m_trimTimer.start();
+}
+
+void ScreenshotThumbnailCache::scheduleTrim()
+{
+    if (!m_trimTimer.isActive()) {
+        m_trimTimer.start();
+    }
+}
+
+QString ScreenshotThumbnailCache::cachePath(const QUrl &thumbnail) const
+{
+    const QByteArray key = QCryptographicHash::hash(thumbnail.toEncoded(), QCryptographicHash::Sha1).toHex();
+    return m_cacheDir + QLatin1Char('/') + QString::fromLatin1(key);
+}
+
+QUrl ScreenshotThumbnailCache::cachedThumbnail(const QUrl &thumbnail) const
+{
+    const QString path = cachePath(thumbnail);
+    return QFileInfo::exists(path) ? QUrl::fromLocalFile(path) : QUrl();
+}
+
+void ScreenshotThumbnailCache::prefetch(const QUrl &thumbnail, const QSize &size)
+{
+    if (!thumbnail.isValid() || thumbnail.isLocalFile() || m_active.contains(thumbnail) || m_validated.contains(thumbnail)
+        || m_failed.contains(thumbnail)) {
+        return;
+    }
+
+    m_queue.removeIf([&thumbnail](const Request &request) {
+        return request.thumbnail == thumbnail;
+    });
+    m_queue.prepend({thumbnail, size});
+    startNext();
+}
+
+void ScreenshotThumbnailCache::startNext()
+{
+    if (!m_nam) {
+        m_nam = new QNetworkAccessManager(this);
+        m_nam->setTransferTimeout();
+    }
+
+    while (m_active.size() < s_maxConcurrentDownloads && !m_queue.isEmpty()) {
+        const Request request = m_queue.takeFirst();
+        m_active.insert(request.thumbnail);
+
+        QNetworkRequest networkRequest(request.thumbnail);
+        const QString path = cachePath(request.thumbnail);
+        QFile etag(path + s_etagSuffix);
+        if (QFileInfo::exists(path) && etag.open(QIODevice::ReadOnly)) {
+            networkRequest.setRawHeader("If-None-Match", etag.readAll());
+        }
+
+        auto reply = m_nam->get(networkRequest);
+        connect(reply, &QNetworkReply::finished, this, [this, reply, size = request.size] {
+            downloaded(reply, size);
+        });
+    }
+}
+
+void ScreenshotThumbnailCache::downloaded(QNetworkReply *reply, const QSize &size)
+{
+    reply->deleteLater();
+    const QUrl thumbnail = reply->request().url();
+    const QString path = cachePath(thumbnail);
+
+    if (reply->error() != QNetworkReply::NoError) {
+        qCDebug(LIBDISCOVER_LOG) << "Could not fetch screenshot thumbnail" << thumbnail << reply->errorString();
+        m_failed.insert(thumbnail);
+        finished(thumbnail);
+        return;
+    }
+
+    if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304) {
+        // Still up to date, mark it as recently used
+        QFile file(path);
+        if (file.open(QIODevice::ReadWrite)) {
+            file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+        }
+        m_validated.insert(thumbnail);
+        finished(thumbnail);
+        return;
+    }
+
+    auto watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, thumbnail, path] {
+        watcher->deleteLater();
+        const bool stored = watcher->result();
+        if (stored) {
+            m_validated.insert(thumbnail);
+            scheduleTrim();
+        } else {
+            m_failed.insert(thumbnail);
+        }
+        finished(thumbnail);
+        if (stored) {
+            Q_EMIT thumbnailCached(thumbnail, QUrl::fromLocalFile(path));
+        }
+    });
+    watcher->setFuture(QtConcurrent::run(storeThumbnail, path, reply->readAll(), reply->rawHeader("ETag"), size));
+}
+
+void ScreenshotThumbnailCache::finished(const QUrl &thumbnail)
+{
+    m_active.remove(thumbnail);
+    startNext();
+}
+
+#include "moc_ScreenshotThumbnailCache.cpp"
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+// SPDX-FileCopyrightText: 2026 Plasma Discover contributors
+
+#pragma once
+
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QSize>
+#include <QTimer>
+#include <QUrl>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// Keeps downscaled copies of the screenshot thumbnails on disk so galleries
+// can be shown straight away when a page is visited again. Thumbnails are
+// downloaded a few at a time, most recent request first, then downscaled off
+// the main thread when they are larger than needed. Cached thumbnails are
+// revalidated against their ETag once per session.
+class ScreenshotThumbnailCache : public QObject
+{
+    Q_OBJECT
+public:
+    static ScreenshotThumbnailCache *instance();
+
+    // Local copy of @p thumbnail, empty if it's not cached yet
+    QUrl cachedThumbnail(const QUrl &thumbnail) const;
+
+    // Queues @p thumbnail to be downloaded or revalidated, ahead of the older requests
+    void prefetch(const QUrl &thumbnail, const QSize &size);
+
+Q_SIGNALS:
+    void thumbnailCached(const QUrl &thumbnail, const QUrl &cachedThumbnail);
+
+private:
+    ScreenshotThumbnailCache();
+    void startNext();
+    void downloaded(QNetworkReply *reply, const QSize &size);
+    void finished(const QUrl &thumbnail);
+    QString cachePath(const QUrl &thumbnail) const;
+    void scheduleTrim();
+
+    struct Request {
+        QUrl thumbnail;
+        QSize size;
+    };
+    QList<Request> m_queue;
+    QSet<QUrl> m_active;
+    QSet<QUrl> m_validated;
+    QSet<QUrl> m_failed;
+    QTimer m_trimTimer;
+    QNetworkAccessManager *m_nam = nullptr;
+    const QString m_cacheDir;
+};
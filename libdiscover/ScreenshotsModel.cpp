@@ -5,8 +5,10 @@
  */
 
 #include "ScreenshotsModel.h"
+#include "ScreenshotThumbnailCache.h"
 #include "libdiscover_debug.h"
 #include "utils.h"
+#include <QFile>
 #include <resources/AbstractResource.h>
 // #include <QAbstractItemModelTester>
 
@@ -14,6 +16,7 @@ ScreenshotsModel::ScreenshotsModel(QObject *parent)
     : QAbstractListModel(parent)
     , m_resource(nullptr)
 {
+    connect(ScreenshotThumbnailCache::instance(), &ScreenshotThumbnailCache::thumbnailCached, this, &ScreenshotsModel::thumbnailCached);
 }
 
 QHash<int, QByteArray> ScreenshotsModel::roleNames() const
@@ -40,7 +43,9 @@ void ScreenshotsModel::setResource(AbstractResource *res)
 
     beginResetModel();
     m_screenshots.clear();
+    m_cachedThumbnails.clear();
     endResetModel();
+    setCurrentIndex(0);
 
     if (res) {
         connect(m_resource, &AbstractResource::screenshotsFetched, this, &ScreenshotsModel::screenshotsFetched);
@@ -61,12 +66,80 @@ void ScreenshotsModel::screenshotsFetched(const Screenshots &screenshots)
         return;
     }
 
+    // Thumbnails we kept from an earlier visit can be shown right away
+    auto cache = ScreenshotThumbnailCache::instance();
+    for (const Screenshot &screenshot : screenshots) {
+        if (screenshot.isAnimated) {
+            continue;
+        }
+        const QUrl cached = cache->cachedThumbnail(screenshot.thumbnail);
+        if (!cached.isEmpty()) {
+            m_cachedThumbnails.insert(screenshot.thumbnail, cached);
+        }
+    }
+
     beginInsertRows(QModelIndex(), m_screenshots.size(), m_screenshots.size() + screenshots.size() - 1);
     m_screenshots += screenshots;
+    // Before the views get to ask for the thumbnails
+    prefetchThumbnails();
     endInsertRows();
     Q_EMIT countChanged();
 }
 
+void ScreenshotsModel::thumbnailCached(const QUrl &thumbnail, const QUrl &cachedThumbnail)
+{
+    const bool shown = kContains(m_screenshots, [&thumbnail](const Screenshot &screenshot) {
+        return screenshot.thumbnail == thumbnail && !screenshot.isAnimated;
+    });
+    if (shown) {
+        m_cachedThumbnails.insert(thumbnail, cachedThumbnail);
+        thumbnailChanged(thumbnail);
+    }
+}
+
+void ScreenshotsModel::thumbnailChanged(const QUrl &thumbnail)
+{
+    for (int row = 0, count = m_screenshots.count(); row < count; ++row) {
+        if (m_screenshots.at(row).thumbnail == thumbnail) {
+            const QModelIndex idx = index(row, 0);
+            Q_EMIT dataChanged(idx, idx, {ThumbnailUrl});
+        }
+    }
+}
+
+int ScreenshotsModel::currentIndex() const
+{
+    return m_currentIndex;
+}
+
+void ScreenshotsModel::setCurrentIndex(int currentIndex)
+{
+    if (m_currentIndex == currentIndex) {
+        return;
+    }
+    m_currentIndex = currentIndex;
+    Q_EMIT currentIndexChanged();
+    prefetchThumbnails();
+}
+
+void ScreenshotsModel::prefetchThumbnails()
+{
+    // Only the shown screenshot and its neighbours, the rest load their original thumbnails.
+    // Requests made last are served first, so the current one goes last.
+    auto cache = ScreenshotThumbnailCache::instance();
+    for (int distance = 1; distance >= 0; --distance) {
+        for (const int row : {m_currentIndex + distance, m_currentIndex - distance}) {
+            if (row < 0 || row >= m_screenshots.count()) {
+                continue;
+            }
+            const Screenshot &screenshot = m_screenshots.at(row);
+            if (!screenshot.isAnimated) {
+                cache->prefetch(screenshot.thumbnail, screenshot.thumbnailSize);
+            }
+        }
+    }
+}
+
 QVariant ScreenshotsModel::data(const QModelIndex &index, int role) const
 {
     if (!index.isValid() || index.parent().isValid()) {
@@ -74,8 +147,11 @@ QVariant ScreenshotsModel::data(const QModelIndex &index, int role) const
     }
 
     switch (role) {
-    case ThumbnailUrl:
-        return m_screenshots[index.row()].thumbnail;
+    case ThumbnailUrl: {
+        // The original is shown until the downscaled copy is ready
+        const QUrl &thumbnail = m_screenshots[index.row()].thumbnail;
+        return m_cachedThumbnails.value(thumbnail, thumbnail);
+    }
     case ScreenshotUrl:
         return m_screenshots[index.row()].screenshot;
     case IsAnimatedRole:
@@ -99,6 +175,15 @@ int ScreenshotsModel::count() const
 
 void ScreenshotsModel::remove(const QUrl &url)
 {
+    // A broken cached copy, fall back to the original thumbnail
+    const QUrl thumbnail = m_cachedThumbnails.key(url);
+    if (!thumbnail.isEmpty()) {
+        m_cachedThumbnails.remove(thumbnail);
+        QFile::remove(url.toLocalFile());
+        thumbnailChanged(thumbnail);
+        return;
+    }
+
     int idxRemove = kIndexOf(m_screenshots, [url](const Screenshot &s) {
         return s.thumbnail == url || s.screenshot == url;
     });
@@ -18,6 +18,7 @@ class DISCOVERCOMMON_EXPORT ScreenshotsModel : public QAbstractListModel
     Q_OBJECT
     Q_PROPERTY(AbstractResource *application READ resource WRITE setResource NOTIFY resourceChanged)
     Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(int currentIndex READ currentIndex WRITE setCurrentIndex NOTIFY currentIndexChanged)
 public:
     enum Roles {
         ThumbnailUrl = Qt::UserRole + 1,
@@ -37,16 +38,26 @@ public:
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     int count() const;
 
+    int currentIndex() const;
+    void setCurrentIndex(int currentIndex);
+
     Q_INVOKABLE void remove(const QUrl &url);
 
 private Q_SLOTS:
     void screenshotsFetched(const Screenshots &screenshots);
+    void thumbnailCached(const QUrl &thumbnail, const QUrl &cachedThumbnail);
 
 Q_SIGNALS:
     void countChanged();
+    void currentIndexChanged();
     void resourceChanged(const AbstractResource *resource);
 
 private:
+    void prefetchThumbnails();
+    void thumbnailChanged(const QUrl &thumbnail);
+
     AbstractResource *m_resource;
     Screenshots m_screenshots;
+    QHash<QUrl, QUrl> m_cachedThumbnails;
+    int m_currentIndex = 0;
 };
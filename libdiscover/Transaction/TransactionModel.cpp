@@ -11,6 +11,8 @@
 #include <QDebug>
 #include <QMetaProperty>
 
+#include <algorithm>
+
 // Own includes
 #include "libdiscover_debug.h"
 #include "resources/AbstractResource.h"
@@ -29,6 +31,10 @@ TransactionModel::TransactionModel(QObject *parent)
     connect(this, &QAbstractItemModel::rowsRemoved, this, &TransactionModel::countChanged);
     connect(this, &TransactionModel::countChanged, this, &TransactionModel::progressChanged);
     connect(this, &TransactionModel::countChanged, this, &TransactionModel::activeTransactionsChanged);
+
+    m_progressTimer.setSingleShot(true);
+    m_progressTimer.setInterval(1000 / 30);
+    connect(&m_progressTimer, &QTimer::timeout, this, &TransactionModel::notifyProgress);
 }
 
 QHash<int, QByteArray> TransactionModel::roleNames() const
@@ -110,13 +116,7 @@ QVariant TransactionModel::data(const QModelIndex &index, int role) const
 
 Transaction *TransactionModel::transactionFromResource(AbstractResource *resource) const
 {
-    for (const auto transaction : std::as_const(m_transactions)) {
-        if (transaction->resource() == resource) {
-            return transaction;
-        }
-    }
-
-    return nullptr;
+    return m_resourceTransactions.value(resource);
 }
 
 QModelIndex TransactionModel::indexOf(Transaction *transaction) const
@@ -151,6 +151,7 @@ void TransactionModel::addTransaction(Transaction *transaction)
     int before = m_transactions.size();
     beginInsertRows(QModelIndex(), before, before + 1);
     m_transactions.append(transaction);
+    m_resourceTransactions.tryEmplace(transaction->resource(), transaction);
 
     if (before == 0) { // Should emit before count changes
         Q_EMIT mainTransactionTextChanged();
@@ -165,8 +166,10 @@ void TransactionModel::addTransaction(Transaction *transaction)
         transactionChanged(transaction, CancellableRole);
     });
     connect(transaction, &Transaction::progressChanged, this, [this, transaction]() {
-        transactionChanged(transaction, ProgressRole);
-        Q_EMIT progressChanged();
+        m_progressedTransactions.insert(transaction);
+        if (!m_progressTimer.isActive()) {
+            m_progressTimer.start();
+        }
     });
 
     Q_EMIT transactionAdded(transaction);
@@ -183,11 +186,25 @@ void TransactionModel::removeTransaction(Transaction *transaction)
     }
 
     disconnect(transaction, nullptr, this, nullptr);
+    m_progressedTransactions.remove(transaction);
 
     beginRemoveRows(QModelIndex(), index, index);
     m_transactions.removeAt(index);
     endRemoveRows();
 
+    auto it = m_resourceTransactions.find(transaction->resource());
+    if (it != m_resourceTransactions.end() && *it == transaction) {
+        // Another transaction may be queued for the same resource
+        const auto next = std::find_if(m_transactions.constBegin(), m_transactions.constEnd(), [transaction](Transaction *other) {
+            return other->resource() == transaction->resource();
+        });
+        if (next != m_transactions.constEnd()) {
+            *it = *next;
+        } else {
+            m_resourceTransactions.erase(it);
+        }
+    }
+
     Q_EMIT transactionRemoved(transaction);
     if (m_transactions.isEmpty()) {
         Q_EMIT lastTransactionFinished();
@@ -204,6 +221,25 @@ void TransactionModel::transactionChanged(Transaction *transaction, int role)
     Q_EMIT dataChanged(index, index, {role});
 }
 
+void TransactionModel::notifyProgress()
+{
+    if (m_progressedTransactions.isEmpty()) {
+        return;
+    }
+
+    int first = m_transactions.size();
+    int last = -1;
+    for (Transaction *transaction : std::as_const(m_progressedTransactions)) {
+        const int row = m_transactions.indexOf(transaction);
+        first = std::min(first, row);
+        last = std::max(last, row);
+    }
+    m_progressedTransactions.clear();
+
+    Q_EMIT dataChanged(index(first), index(last), {ProgressRole});
+    Q_EMIT progressChanged();
+}
+
 int TransactionModel::progress() const
 {
     int sum = 0;
@@ -7,6 +7,9 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
 
 #include "Transaction.h"
 
@@ -64,6 +67,11 @@ public:
 
 private:
     QVector<Transaction *> m_transactions;
+    // The first transaction in the model for each resource
+    QHash<AbstractResource *, Transaction *> m_resourceTransactions;
+    // Progress changes are notified at most once per frame
+    QSet<Transaction *> m_progressedTransactions;
+    QTimer m_progressTimer;
 
 Q_SIGNALS:
     void startingFirstTransaction();
@@ -78,4 +86,5 @@ Q_SIGNALS:
 
 private:
     void transactionChanged(Transaction *transaction, int role);
+    void notifyProgress();
 };
@@ -7,6 +7,7 @@
 #include "AppStreamConcurrentPool.h"
 
 #include <QDebug>
+#include <QSet>
 #include <QtConcurrentMap>
 #include <QtConcurrentRun>
 
@@ -80,6 +81,39 @@ QFuture<ComponentBox> ConcurrentPool::componentsByCategories(const QStringList &
     });
 }
 
+QFuture<ComponentBox> ConcurrentPool::componentsByAnyCategory(const QStringList &categories, Bundle::Kind bundleKind)
+{
+    return QtConcurrent::run(m_threadPool.get(), [this, categories, bundleKind] {
+        const QSet<QString> wanted(categories.cbegin(), categories.cend());
+        QSet<QString> found;
+        ComponentBox ret(ComponentBox::FlagNoChecks);
+
+        ComponentBox components(ComponentBox::FlagNoChecks);
+        {
+            // Only hold the pool while copying, the walk can take a while
+            QMutexLocker lock(&m_mutex);
+            components = m_pool->components();
+        }
+        for (const Component &component : std::as_const(components)) {
+            const QStringList componentCategories = component.categories();
+            const bool matches = std::any_of(componentCategories.cbegin(), componentCategories.cend(), [&wanted](const QString &category) {
+                return wanted.contains(category);
+            });
+            if (!matches) {
+                continue;
+            }
+
+            const QString key = bundleKind == Bundle::KindUnknown ? component.id() : component.bundle(bundleKind).id();
+            if (found.contains(key)) {
+                continue;
+            }
+            found.insert(key);
+            ret.add(component);
+        }
+        return ret;
+    });
+}
+
 QFuture<ComponentBox> ConcurrentPool::componentsByLaunchable(Launchable::Kind kind, const QString &value)
 {
     return QtConcurrent::run(m_threadPool.get(), [this, kind, value] {
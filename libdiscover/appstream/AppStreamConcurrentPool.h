@@ -44,6 +44,15 @@ public:
 
     QFuture<ComponentBox> componentsByCategories(const QStringList &categories);
 
+    /**
+     * Components in any of @p categories, walking the pool only once. Unlike
+     * componentsByCategories, which requires all of them.
+     *
+     * Components are listed once per bundle id of @p bundleKind, or per
+     * component id when it's Bundle::KindUnknown.
+     */
+    QFuture<ComponentBox> componentsByAnyCategory(const QStringList &categories, Bundle::Kind bundleKind);
+
     QFuture<ComponentBox> componentsByLaunchable(Launchable::Kind kind, const QString &value);
 
     QFuture<ComponentBox> componentsByExtends(const QString &extendedId);
@@ -23,7 +23,6 @@
 #include <QJsonObject>
 #include <QMetaEnum>
 #include <QUrlQuery>
-#include <QtConcurrentRun>
 
 using namespace std::chrono_literals;
 using namespace AppStreamUtils;
@@ -171,20 +170,6 @@ uint AppStreamUtils::contentRatingMinimumAge(const AppStream::Component &appdata
     return minimumAge;
 }
 
-static void kRemoveDuplicates(AppStream::ComponentBox &input, AppStream::Bundle::Kind kind)
-{
-    QSet<QString> ret;
-    for (auto it = input.begin(); it != input.end();) {
-        const auto key = kind == AppStream::Bundle::KindUnknown ? it->id() : it->bundle(kind).id();
-        if (!ret.contains(key)) {
-            ret << key;
-            ++it;
-        } else {
-            it = input.erase(it);
-        }
-    }
-}
-
 QFuture<AppStream::ComponentBox>
 AppStreamUtils::componentsByCategoriesTask(AppStream::ConcurrentPool *pool, const std::shared_ptr<Category> &cat, AppStream::Bundle::Kind kind)
 {
@@ -192,31 +177,17 @@ AppStreamUtils::componentsByCategoriesTask(AppStream::ConcurrentPool *pool, cons
         return pool->componentsByKind(AppStream::Component::KindDesktopApp);
     }
 
-    const auto categories = cat->involvedCategories();
-    QList<QFuture<AppStream::ComponentBox>> futures;
-    futures.reserve(categories.size());
     if (cat->type() == Category::Type::Driver) {
-        futures += pool->componentsByKind(AppStream::Component::KindDriver);
+        return pool->componentsByKind(AppStream::Component::KindDriver);
     } else if (cat->type() == Category::Type::Font) {
-        futures += pool->componentsByKind(AppStream::Component::KindFont);
-    } else {
-        for (const auto &categoryName : categories) {
-            futures += pool->componentsByCategories({categoryName});
-        }
+        return pool->componentsByKind(AppStream::Component::KindFont);
     }
 
-    if (futures.size() == 1) {
-        return futures.constFirst();
+    const auto categories = cat->involvedCategories();
+    if (categories.size() == 1) {
+        return pool->componentsByCategories(categories);
     }
-
-    return QtConcurrent::run([futures, kind]() -> AppStream::ComponentBox {
-        AppStream::ComponentBox ret(AppStream::ComponentBox::FlagNoChecks);
-        for (const auto &box : futures) {
-            ret += box.result();
-        }
-        kRemoveDuplicates(ret, kind);
-        return ret;
-    });
+    return pool->componentsByAnyCategory(categories, kind);
 }
 
 DISCOVERCOMMON_EXPORT bool AppStreamUtils::kIconLoaderHasIcon(const QString &name)
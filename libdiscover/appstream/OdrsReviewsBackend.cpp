@@ -31,6 +31,7 @@
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QStandardPaths>
+#include <QThreadPool>
 
 #include <QFutureWatcher>
 #include <QtConcurrentRun>
@@ -38,6 +39,13 @@
 // #define APIURL "http://127.0.0.1:5000/1.0/reviews/api"
 #define APIURL "https://odrs.gnome.org/1.0/reviews/api"
 
+// Reviews requested at once, the model asks for more pages as needed
+static constexpr int s_reviewsPerPage = 20;
+// Cached pages of reviews are used without asking the server for a day
+static constexpr qint64 s_reviewsCacheMaxAge = 1000 * 60 * 60 * 24;
+// Past that, they're only kept for a week in case the server can't be reached
+static constexpr qint64 s_reviewsCacheStaleAge = s_reviewsCacheMaxAge * 7;
+
 QSharedPointer<OdrsReviewsBackend> OdrsReviewsBackend::global()
 {
     static QSharedPointer<OdrsReviewsBackend> var = nullptr;
@@ -48,10 +56,34 @@ QSharedPointer<OdrsReviewsBackend> OdrsReviewsBackend::global()
     return var;
 }
 
+static QString reviewsCacheRoot()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1StringView("/odrs-reviews");
+}
+
+// Pages are keyed on the version and locale too, so old ones are never overwritten
+static void pruneReviewsCache()
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    QDir root(reviewsCacheRoot());
+    const auto directories = root.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QFileInfo &directory : directories) {
+        QDir dir(directory.absoluteFilePath());
+        const auto pages = dir.entryInfoList(QDir::Files);
+        for (const QFileInfo &page : pages) {
+            if (page.lastModified().msecsTo(now) > s_reviewsCacheStaleAge) {
+                dir.remove(page.fileName());
+            }
+        }
+        root.rmdir(directory.fileName());
+    }
+}
+
 OdrsReviewsBackend::OdrsReviewsBackend()
     : AbstractReviewsBackend(nullptr)
 {
     fetchRatings();
+    QThreadPool::globalInstance()->start(pruneReviewsCache);
 }
 
 OdrsReviewsBackend::~OdrsReviewsBackend()
@@ -129,6 +161,13 @@ static QString userHash()
     return QString::fromUtf8(QCryptographicHash::hash(salted, QCryptographicHash::Sha1).toHex());
 }
 
+static QString reviewsCacheDirectory(const QString &appstreamId)
+{
+    QString directoryName = appstreamId;
+    directoryName.replace(QLatin1Char('/'), QLatin1Char('_'));
+    return reviewsCacheRoot() + QLatin1Char('/') + directoryName;
+}
+
 ReviewsJob *OdrsReviewsBackend::fetchReviews(AbstractResource *resource, int page)
 {
     if (resource->appstreamId().isEmpty()) {
@@ -137,7 +176,6 @@ ReviewsJob *OdrsReviewsBackend::fetchReviews(AbstractResource *resource, int pag
         ret->deleteLater();
         return ret;
     }
-    Q_UNUSED(page)
     QString version = resource->isInstalled() ? resource->installedVersion() : resource->availableVersion();
     if (version.isEmpty()) {
         version = QLatin1StringView("unknown");
@@ -149,7 +187,8 @@ ReviewsJob *OdrsReviewsBackend::fetchReviews(AbstractResource *resource, int pag
         {QLatin1StringView("user_hash"), userHash()},
         {QLatin1StringView("version"), version},
         {QLatin1StringView("locale"), QLocale::system().name()},
-        {QLatin1StringView("limit"), -1},
+        {QLatin1StringView("start"), (std::max(page, 1) - 1) * s_reviewsPerPage},
+        {QLatin1StringView("limit"), s_reviewsPerPage},
     });
 
     const auto json = document.toJson(QJsonDocument::Compact);
@@ -158,10 +197,21 @@ ReviewsJob *OdrsReviewsBackend::fetchReviews(AbstractResource *resource, int pag
         // If we already have it issued, reused. It happens if a query reset was made e.g. because the state changed
         return job;
     }
-    QNetworkRequest request(QUrl(QStringLiteral(APIURL "/fetch")));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, QLatin1StringView("application/json; charset=utf-8"));
-    request.setHeader(QNetworkRequest::ContentLengthHeader, json.size());
-    job = OdrsReviewsJob::create(nam()->post(request, json), resource);
+
+    // The request identifies the app, version, locale and page, so it's a good cache key
+    const QString cachePath = reviewsCacheDirectory(resource->appstreamId()) + QLatin1Char('/')
+        + QString::fromLatin1(QCryptographicHash::hash(json, QCryptographicHash::Sha1).toHex()) + QLatin1StringView(".json");
+    const QFileInfo cacheInfo(cachePath);
+    QFile cacheFile(cachePath);
+    if (cacheInfo.exists() && cacheInfo.lastModified().msecsTo(QDateTime::currentDateTime()) < s_reviewsCacheMaxAge
+        && cacheFile.open(QIODevice::ReadOnly)) {
+        job = OdrsReviewsJob::createCached(cacheFile.readAll(), resource, s_reviewsPerPage);
+    } else {
+        QNetworkRequest request(QUrl(QStringLiteral(APIURL "/fetch")));
+        request.setHeader(QNetworkRequest::ContentTypeHeader, QLatin1StringView("application/json; charset=utf-8"));
+        request.setHeader(QNetworkRequest::ContentLengthHeader, json.size());
+        job = OdrsReviewsJob::create(nam()->post(request, json), resource, s_reviewsPerPage, cachePath);
+    }
     connect(job, &ReviewsJob::reviewsReady, this, [this, json] {
         m_jobs.remove(json);
     });
@@ -170,11 +220,16 @@ ReviewsJob *OdrsReviewsBackend::fetchReviews(AbstractResource *resource, int pag
 
 Rating OdrsReviewsBackend::ratingForApplication(AbstractResource *resource) const
 {
+    // Entries are dropped as soon as their resource is destroyed, so they can be trusted as is
+    if (const auto it = m_resourceRatings.constFind(resource); it != m_resourceRatings.constEnd()) {
+        return *it;
+    }
+
     if (resource->appstreamId().isEmpty()) {
         return {};
     }
 
-    return m_current.ratings[resource->appstreamId().toLower()];
+    return m_current.ratings.value(resource->appstreamId().toLower());
 }
 
 void OdrsReviewsBackend::submitUsefulness(Review *review, bool useful)
@@ -232,6 +287,9 @@ OdrsReviewsBackend::sendReview(AbstractResource *resource, const QString &summar
 
     const QJsonDocument document(map);
 
+    // Make sure the new review shows up next time the reviews are fetched
+    QDir(reviewsCacheDirectory(resource->appstreamId())).removeRecursively();
+
     const auto accessManager = nam();
     QNetworkRequest request(QUrl(QStringLiteral(APIURL "/submit")));
     request.setHeader(QNetworkRequest::ContentTypeHeader, QLatin1StringView("application/json; charset=utf-8"));
@@ -331,16 +389,46 @@ bool OdrsReviewsBackend::isResourceSupported(AbstractResource *resource) const
     return !resource->appstreamId().isEmpty();
 }
 
-void OdrsReviewsBackend::emitRatingFetched(AbstractResourcesBackend *backend, const QList<AbstractResource *> &resources) const
+void OdrsReviewsBackend::emitRatingFetched(AbstractResourcesBackend *backend, const QList<AbstractResource *> &resources)
 {
-    backend->emitRatingsReady();
+    QList<AbstractResource *> changed;
     for (const auto resource : resources) {
-        if (m_current.ratings.contains(resource->appstreamId())) {
-            Q_EMIT resource->ratingFetched();
+        const QString appstreamId = resource->appstreamId();
+        auto previous = m_resourceRatings.find(resource);
+        const bool hadRating = previous != m_resourceRatings.end();
+
+        const auto current = appstreamId.isEmpty() ? m_current.ratings.constEnd() : m_current.ratings.constFind(appstreamId.toLower());
+        if (current == m_current.ratings.constEnd()) {
+            if (hadRating) {
+                m_resourceRatings.erase(previous);
+                changed << resource;
+            }
+            continue;
+        }
+
+        if (!hadRating || previous->ratingCount() != current->ratingCount() || previous->ratingPoints() != current->ratingPoints()) {
+            changed << resource;
         }
+        if (previous == m_resourceRatings.end()) {
+            connect(resource, &QObject::destroyed, this, &OdrsReviewsBackend::forgetResource, Qt::UniqueConnection);
+        }
+        m_resourceRatings.insert(resource, *current);
+    }
+
+    // Models update all the rating roles of the backend at once, only objects
+    // bound to a specific resource need to hear about it
+    backend->emitRatingsReady();
+    for (const auto resource : std::as_const(changed)) {
+        Q_EMIT resource->ratingFetched();
     }
 }
 
+void OdrsReviewsBackend::forgetResource(QObject *resource)
+{
+    // Only the address is used, the resource is already gone
+    m_resourceRatings.remove(static_cast<const AbstractResource *>(resource));
+}
+
 QNetworkAccessManager *OdrsReviewsBackend::nam()
 {
     if (!m_delayedNam) {
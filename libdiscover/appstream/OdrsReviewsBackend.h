@@ -54,7 +54,11 @@ public:
     }
     void submitUsefulness(Review *review, bool useful) override;
     bool isResourceSupported(AbstractResource *resource) const override;
-    void emitRatingFetched(AbstractResourcesBackend *backend, const QList<AbstractResource *> &resources) const;
+    /**
+     * Indexes the ratings of @p resources and notifies @p backend about them
+     * in bulk. Only resources whose rating changed get their own ratingFetched.
+     */
+    void emitRatingFetched(AbstractResourcesBackend *backend, const QList<AbstractResource *> &resources);
     QString errorMessage() const override
     {
         return m_errorMessage;
@@ -82,6 +86,7 @@ private:
     void setFetching(bool fetching);
     QNetworkAccessManager *nam();
     void parseRatings();
+    void forgetResource(QObject *resource);
 
     QString m_errorMessage;
     bool m_isFetching = false;
@@ -92,4 +97,9 @@ private:
         QHash<QString, Rating> ratings;
         QList<Rating> top;
     } m_current;
+
+    // Ratings of the resources handed to emitRatingFetched, saves looking them
+    // up by lowercased appstream id every time a view or a sort asks for them.
+    // Entries go away along with their resource.
+    QHash<const AbstractResource *, Rating> m_resourceRatings;
 };
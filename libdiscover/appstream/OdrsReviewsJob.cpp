@@ -11,7 +11,12 @@
 #include <resources/AbstractResource.h>
 
 #include <KLocalizedString>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QJsonDocument>
+#include <QSaveFile>
+#include <QTimer>
 
 #include "libdiscover_debug.h"
 
@@ -39,21 +44,34 @@ void OdrsSubmitReviewsJob::reviewSubmitted()
     }
 }
 
-OdrsReviewsJob::OdrsReviewsJob(QNetworkReply *reply, AbstractResource *resource)
+OdrsReviewsJob::OdrsReviewsJob(QNetworkReply *reply, AbstractResource *resource, int pageSize)
     : m_reply(reply)
     , m_resource(resource)
+    , m_pageSize(pageSize)
 {
-    Q_ASSERT(m_reply);
     Q_ASSERT(m_resource);
 }
 
-OdrsReviewsJob *OdrsReviewsJob::create(QNetworkReply *reply, AbstractResource *resource)
+OdrsReviewsJob *OdrsReviewsJob::create(QNetworkReply *reply, AbstractResource *resource, int pageSize, const QString &cachePath)
 {
-    auto r = new OdrsReviewsJob(reply, resource);
+    Q_ASSERT(reply);
+    auto r = new OdrsReviewsJob(reply, resource, pageSize);
+    r->m_cachePath = cachePath;
     connect(reply, &QNetworkReply::finished, r, &OdrsReviewsJob::reviewsFetched);
     return r;
 }
 
+OdrsReviewsJob *OdrsReviewsJob::createCached(const QByteArray &data, AbstractResource *resource, int pageSize)
+{
+    auto r = new OdrsReviewsJob(nullptr, resource, pageSize);
+    // Give the caller the chance to connect to reviewsReady
+    QTimer::singleShot(0, r, [r, data] {
+        r->parseReviews(QJsonDocument::fromJson(data));
+        r->deleteLater();
+    });
+    return r;
+}
+
 OdrsReviewsJob::~OdrsReviewsJob()
 {
     delete m_reply;
@@ -65,6 +83,13 @@ void OdrsReviewsJob::reviewsFetched()
     const auto networkError = m_reply->error();
     if (networkError != QNetworkReply::NoError) {
         qCWarning(LIBDISCOVER_LOG) << "OdrsReviewsBackend: Error fetching reviews:" << m_reply->errorString() << data;
+        QFile cacheFile(m_cachePath);
+        if (!m_cachePath.isEmpty() && cacheFile.open(QIODevice::ReadOnly)) {
+            // Outdated reviews are better than none
+            parseReviews(QJsonDocument::fromJson(cacheFile.readAll()));
+            deleteLater();
+            return;
+        }
         Q_EMIT errorMessage(i18n("Technical error message: %1", m_reply->errorString()));
         Q_EMIT reviewsReady({}, false);
         deleteLater();
@@ -75,6 +100,15 @@ void OdrsReviewsJob::reviewsFetched()
     const QJsonDocument document = QJsonDocument::fromJson(data, &error);
     if (error.error) {
         qCWarning(LIBDISCOVER_LOG) << "OdrsReviewsBackend: Error parsing reviews:" << m_reply->url() << error.errorString();
+    } else if (!m_cachePath.isEmpty()) {
+        QDir().mkpath(QFileInfo(m_cachePath).absolutePath());
+        QSaveFile cacheFile(m_cachePath);
+        if (cacheFile.open(QIODevice::WriteOnly)) {
+            cacheFile.write(data);
+            cacheFile.commit();
+        } else {
+            qCWarning(LIBDISCOVER_LOG) << "OdrsReviewsBackend: Could not cache reviews:" << cacheFile.errorString();
+        }
     }
     parseReviews(document);
     deleteLater();
@@ -156,7 +190,8 @@ void OdrsReviewsJob::parseReviews(const QJsonDocument &document)
         }
     }
 
-    Q_EMIT reviewsReady(reviewsList, false);
+    // A full page means the server may have more for us
+    Q_EMIT reviewsReady(reviewsList, m_pageSize > 0 && reviews.size() >= m_pageSize);
 }
 
 #include "moc_OdrsReviewsJob.cpp"
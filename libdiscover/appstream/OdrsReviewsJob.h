@@ -18,15 +18,24 @@ class OdrsReviewsJob : public ReviewsJob
 public:
     ~OdrsReviewsJob();
 
-    static OdrsReviewsJob *create(QNetworkReply *reply, AbstractResource *resource);
+    /**
+     * Fetches a page of reviews. A full page of @p pageSize reviews means there
+     * may be more. Successful replies are stored in @p cachePath if not empty.
+     */
+    static OdrsReviewsJob *create(QNetworkReply *reply, AbstractResource *resource, int pageSize, const QString &cachePath);
+
+    /// Reports a page of reviews that was previously stored on disk
+    static OdrsReviewsJob *createCached(const QByteArray &data, AbstractResource *resource, int pageSize);
 
 protected:
-    OdrsReviewsJob(QNetworkReply *reply, AbstractResource *resource);
+    OdrsReviewsJob(QNetworkReply *reply, AbstractResource *resource, int pageSize = 0);
     void reviewsFetched();
     void parseReviews(const QJsonDocument &document);
 
     QNetworkReply *const m_reply;
     AbstractResource *const m_resource;
+    const int m_pageSize;
+    QString m_cachePath;
 };
 
 class OdrsSubmitReviewsJob : public OdrsReviewsJob
@@ -75,6 +75,21 @@ void DummyBackend::populate(const QString &n)
     }
 }
 
+void DummyBackend::setStartElements(int startElements)
+{
+    const auto resources = std::exchange(m_resources, {});
+    for (DummyResource *res : resources) {
+        Q_EMIT resourceRemoved(res);
+        delete res;
+    }
+
+    m_startElements = startElements;
+    populate(QStringLiteral("Dummy"));
+    if (!m_fetching)
+        m_reviews->initialize();
+    Q_EMIT contentsChanged();
+}
+
 void DummyBackend::toggleFetching()
 {
     m_fetching = !m_fetching;
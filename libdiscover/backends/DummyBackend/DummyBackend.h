@@ -15,7 +15,7 @@ class DummyResource;
 class DummyBackend : public AbstractResourcesBackend
 {
     Q_OBJECT
-    Q_PROPERTY(int startElements MEMBER m_startElements)
+    Q_PROPERTY(int startElements READ startElements WRITE setStartElements)
 public:
     explicit DummyBackend(QObject *parent = nullptr);
 
@@ -41,6 +41,13 @@ public:
     bool hasApplications() const override;
     InlineMessage *explainDysfunction() const override;
 
+    int startElements() const
+    {
+        return m_startElements;
+    }
+    // Replaces the catalogue with a freshly populated one of @p startElements per kind
+    void setStartElements(int startElements);
+
     int fetchingUpdatesProgress() const override
     {
         return m_fetching > 0 ? 42 : 100;
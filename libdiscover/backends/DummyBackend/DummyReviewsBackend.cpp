@@ -17,6 +17,9 @@
 DummyReviewsBackend::DummyReviewsBackend(DummyBackend *parent)
     : AbstractReviewsBackend(parent)
 {
+    connect(parent, &AbstractResourcesBackend::resourceRemoved, this, [this](AbstractResource *resource) {
+        m_ratings.remove(resource);
+    });
 }
 
 DummyReviewsBackend::~DummyReviewsBackend() noexcept
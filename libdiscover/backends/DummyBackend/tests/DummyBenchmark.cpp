@@ -0,0 +1,389 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 Plasma Discover contributors
+ *
+ *   SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "DiscoverBackendsFactory.h"
+#include <Category/CategoryModel.h>
+#include <Transaction/Transaction.h>
+#include <Transaction/TransactionModel.h>
+#include <UpdateModel/UpdateModel.h>
+#include <resources/AbstractBackendUpdater.h>
+#include <resources/ResourcesModel.h>
+#include <resources/ResourcesProxyModel.h>
+#include <resources/ResourcesUpdatesModel.h>
+
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTest>
+
+#include <algorithm>
+
+// Times the common code paths against a DummyBackend catalogue of growing size.
+//
+// Each benchmark runs its operation a few times and reports the median wall
+// time, which is a lot steadier than the mean once the event loop is involved.
+// Use QtTest's output options to get numbers that can be compared across runs:
+//
+//   dummybenchmark -o results.csv,csv
+//
+// DISCOVER_BENCHMARK_ELEMENTS overrides the catalogue sizes (e.g. "1000,10000")
+// and DISCOVER_BENCHMARK_SAMPLES the amount of runs per measurement.
+
+using namespace Qt::StringLiterals;
+
+static constexpr int s_timeout = 300000;
+
+static QList<int> catalogueSizes()
+{
+    const QByteArray sizes = qgetenv("DISCOVER_BENCHMARK_ELEMENTS");
+    if (sizes.isEmpty()) {
+        return {1000, 10000, 100000};
+    }
+
+    QList<int> ret;
+    for (const QByteArray &size : sizes.split(',')) {
+        ret += size.toInt();
+    }
+    return ret;
+}
+
+static int samples()
+{
+    bool ok = false;
+    const int count = qEnvironmentVariableIntValue("DISCOVER_BENCHMARK_SAMPLES", &ok);
+    return ok && count > 0 ? count : 5;
+}
+
+static void addCatalogueRows()
+{
+    QTest::addColumn<int>("elements");
+    for (int elements : catalogueSizes()) {
+        QTest::addRow("%d", elements) << elements;
+    }
+}
+
+static void addSortRows()
+{
+    QTest::addColumn<int>("elements");
+    QTest::addColumn<ResourcesProxyModel::Roles>("sortRole");
+    for (int elements : catalogueSizes()) {
+        QTest::addRow("%d-name", elements) << elements << ResourcesProxyModel::NameRole;
+        QTest::addRow("%d-rating", elements) << elements << ResourcesProxyModel::SortableRatingRole;
+        QTest::addRow("%d-relevance", elements) << elements << ResourcesProxyModel::SearchRelevanceRole;
+    }
+}
+
+// Runs @p operation and reports the median of its wall time. @p cleanup runs after
+// each sample to bring everything back to the starting point, it isn't measured.
+template<typename Operation, typename Cleanup>
+static void measure(Operation operation, Cleanup cleanup)
+{
+    QList<qint64> elapsed;
+    for (int i = 0, c = samples(); i < c; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        operation();
+        elapsed += timer.nsecsElapsed();
+        if (QTest::currentTestFailed()) {
+            return;
+        }
+
+        cleanup();
+        if (QTest::currentTestFailed()) {
+            return;
+        }
+    }
+
+    const auto median = elapsed.begin() + elapsed.size() / 2;
+    std::nth_element(elapsed.begin(), median, elapsed.end());
+    QTest::setBenchmarkResult(*median / 1000000., QTest::WalltimeMilliseconds);
+}
+
+static bool waitForProxy(ResourcesProxyModel *model)
+{
+    QSignalSpy spy(model, &ResourcesProxyModel::busyChanged);
+    while (model->isBusy()) {
+        if (!spy.wait(s_timeout)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static QVector<StreamResult> fetchResources(ResultsStream *stream)
+{
+    QVector<StreamResult> ret;
+    QObject::connect(stream, &ResultsStream::resourcesFound, stream, [&ret](const QVector<StreamResult> &res) {
+        ret += res;
+    });
+    QSignalSpy spy(stream, &ResultsStream::destroyed);
+    if (!spy.wait(s_timeout)) {
+        qWarning() << "stream did not finish" << stream;
+    }
+    return ret;
+}
+
+class DummyBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    DummyBenchmark(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+        DiscoverBackendsFactory::setRequestedBackends({QStringLiteral("dummy-backend")});
+
+        QStandardPaths::setTestModeEnabled(true);
+        m_model = new ResourcesModel(QStringLiteral("dummy-backend"), this);
+        const QVector<AbstractResourcesBackend *> backends = m_model->backends();
+        for (AbstractResourcesBackend *backend : backends) {
+            if (QLatin1String(backend->metaObject()->className()) == "DummyBackend"_L1) {
+                m_appBackend = backend;
+            }
+        }
+
+        CategoryModel::global()->populateCategories();
+    }
+
+private:
+    // Resizes the catalogue and waits for the updater to know about it
+    bool setCatalogueSize(int elements)
+    {
+        if (m_appBackend->property("startElements").toInt() != elements) {
+            m_appBackend->setProperty("startElements", elements);
+        }
+
+        auto updater = m_appBackend->backendUpdater();
+        QSignalSpy spy(updater, &AbstractBackendUpdater::progressingChanged);
+        while (updater->isProgressing()) {
+            if (!spy.wait(s_timeout)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        QVERIFY(m_appBackend);
+        QSignalSpy spy(m_appBackend, &AbstractResourcesBackend::contentsChanged);
+        QVERIFY(spy.wait());
+        QVERIFY(!CategoryModel::global()->rootCategories().isEmpty());
+    }
+
+    void benchmarkLoad_data()
+    {
+        addCatalogueRows();
+    }
+
+    void benchmarkLoad()
+    {
+        QFETCH(int, elements);
+        QVERIFY(setCatalogueSize(0));
+
+        measure(
+            [this, elements] {
+                QVERIFY(setCatalogueSize(elements));
+                const auto resources = fetchResources(m_appBackend->search({}));
+                QCOMPARE(resources.size(), elements * 2);
+            },
+            [this] {
+                QVERIFY(setCatalogueSize(0));
+            });
+    }
+
+    void benchmarkSort_data()
+    {
+        addSortRows();
+    }
+
+    void benchmarkSort()
+    {
+        QFETCH(int, elements);
+        QFETCH(ResourcesProxyModel::Roles, sortRole);
+        QVERIFY(setCatalogueSize(elements));
+
+        ResourcesProxyModel pm;
+        pm.setSortRole(sortRole);
+        pm.componentComplete();
+        QVERIFY(waitForProxy(&pm));
+        QCOMPARE(pm.rowCount(), elements * 2);
+
+        measure(
+            [&pm] {
+                pm.setSortOrder(pm.sortOrder() == Qt::AscendingOrder ? Qt::DescendingOrder : Qt::AscendingOrder);
+            },
+            [] {});
+    }
+
+    void benchmarkSearch_data()
+    {
+        addSortRows();
+    }
+
+    void benchmarkSearch()
+    {
+        QFETCH(int, elements);
+        QFETCH(ResourcesProxyModel::Roles, sortRole);
+        QVERIFY(setCatalogueSize(elements));
+
+        ResourcesProxyModel pm;
+        pm.setSortRole(sortRole);
+        pm.componentComplete();
+        QVERIFY(waitForProxy(&pm));
+
+        measure(
+            [&pm] {
+                pm.setSearch(QStringLiteral("dummy 1"));
+                QVERIFY(waitForProxy(&pm));
+                QVERIFY(pm.rowCount() > 0);
+            },
+            [&pm] {
+                pm.setSearch(QString());
+                QVERIFY(waitForProxy(&pm));
+            });
+    }
+
+    void benchmarkCategories_data()
+    {
+        addCatalogueRows();
+    }
+
+    void benchmarkCategories()
+    {
+        QFETCH(int, elements);
+        QVERIFY(setCatalogueSize(elements));
+
+        ResourcesProxyModel pm;
+        pm.componentComplete();
+        QVERIFY(waitForProxy(&pm));
+
+        const auto categories = CategoryModel::global()->rootCategories();
+        measure(
+            [&pm, &categories] {
+                for (const auto &category : categories) {
+                    pm.setFiltersFromCategory(category);
+                    QVERIFY(waitForProxy(&pm));
+                }
+            },
+            [&pm] {
+                pm.setFiltersFromCategory({});
+                QVERIFY(waitForProxy(&pm));
+            });
+    }
+
+    void benchmarkUpdateModel_data()
+    {
+        addCatalogueRows();
+    }
+
+    void benchmarkUpdateModel()
+    {
+        QFETCH(int, elements);
+        QVERIFY(setCatalogueSize(elements));
+
+        ResourcesUpdatesModel rum;
+        rum.prepare();
+        const auto resources = rum.toUpdate();
+        QCOMPARE(resources.size(), m_appBackend->updatesCount());
+
+        UpdateModel model;
+        measure(
+            [&model, &resources] {
+                model.setResources(resources);
+                QVERIFY(model.hasUpdates());
+            },
+            [&model] {
+                model.setResources({});
+            });
+    }
+
+    void benchmarkTransactionChurn_data()
+    {
+        addCatalogueRows();
+    }
+
+    void benchmarkTransactionChurn()
+    {
+        QFETCH(int, elements);
+        QVERIFY(setCatalogueSize(elements));
+
+        QList<AbstractResource *> applications;
+        const auto resources = fetchResources(m_appBackend->search({}));
+        for (const StreamResult &result : resources) {
+            if (result.resource->type() == AbstractResource::Application) {
+                applications += result.resource;
+            }
+        }
+        QCOMPARE(applications.size(), elements);
+
+        auto model = TransactionModel::global();
+        measure(
+            [this, model, &applications] {
+                QList<Transaction *> transactions;
+                transactions.reserve(applications.size());
+                for (AbstractResource *resource : std::as_const(applications)) {
+                    auto transaction = m_appBackend->installApplication(resource);
+                    model->addTransaction(transaction);
+                    transactions += transaction;
+                }
+                QCOMPARE(model->rowCount(), applications.size());
+
+                for (Transaction *transaction : std::as_const(transactions)) {
+                    transaction->cancel();
+                }
+                QCOMPARE(model->rowCount(), 0);
+            },
+            [] {
+                QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+            });
+    }
+
+    void benchmarkUpdateAll_data()
+    {
+        addCatalogueRows();
+    }
+
+    void benchmarkUpdateAll()
+    {
+        QFETCH(int, elements);
+        QVERIFY(setCatalogueSize(elements));
+
+        ResourcesUpdatesModel rum;
+        const int updatesCount = m_appBackend->updatesCount();
+        QVERIFY(updatesCount > 0);
+
+        // Measures until every update has its transaction running, updates are then
+        // cancelled so the catalogue stays the same for the next sample
+        measure(
+            [&rum, updatesCount] {
+                rum.prepare();
+                rum.updateAll();
+                Transaction *transaction = rum.transaction();
+                QVERIFY(transaction);
+
+                QSignalSpy spy(transaction, &Transaction::statusChanged);
+                while (transaction->status() != Transaction::CommittingStatus) {
+                    QVERIFY(spy.wait(s_timeout));
+                }
+                // The update transaction itself is also listed
+                QCOMPARE(TransactionModel::global()->rowCount(), updatesCount + 1);
+            },
+            [this, &rum] {
+                rum.transaction()->cancel();
+                QTRY_VERIFY_WITH_TIMEOUT(!rum.isProgressing() && !m_appBackend->backendUpdater()->isProgressing(), s_timeout);
+                QCOMPARE(TransactionModel::global()->rowCount(), 0);
+            });
+    }
+
+private:
+    AbstractResourcesBackend *m_appBackend = nullptr;
+    ResourcesModel *m_model;
+};
+
+QTEST_MAIN(DummyBenchmark)
+
+#include "DummyBenchmark.moc"
@@ -36,13 +36,16 @@
 #include <KSharedConfig>
 
 #include <QCoroCore>
+#include <QCryptographicHash>
 
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QFutureWatcher>
 #include <QNetworkAccessManager>
+#include <QSaveFile>
 #include <QSettings>
+#include <QStandardPaths>
 #include <QTemporaryFile>
 #include <QTextStream>
 #include <QThread>
@@ -55,6 +58,7 @@
 #include <Category/Category.h>
 #include <optional>
 #include <set>
+#include <tuple>
 #include <sys/stat.h>
 
 DISCOVER_BACKEND_PLUGIN(FlatpakBackend)
@@ -73,25 +77,40 @@ QString copyAndFree(char *str)
     return ret;
 }
 
-class ProgressCollector : public QObject
+// Runs the AppStream refreshes a few at a time so they don't all compete for the
+// network and then for the thread pool loading them. Remotes whose lists are still
+// waiting on them go first, then by the remote's priority, slow remotes last.
+class RefreshScheduler : public QObject
 {
     Q_OBJECT
 public:
-    ProgressCollector(FlatpakBackend *backend)
+    RefreshScheduler(FlatpakBackend *backend)
         : m_backend(backend)
+        , m_timings(KSharedConfig::openStateConfig()->group(u"FlatpakRefreshTimings"_s))
     {
-        connect(m_backend->m_updater, &StandardBackendUpdater::settingUpChanged, this, &ProgressCollector::progressChanged);
+        connect(m_backend->m_updater, &StandardBackendUpdater::settingUpChanged, this, &RefreshScheduler::progressChanged);
+
+        const KConfigGroup group = KSharedConfig::openConfig()->group(u"FlatpakBackend"_s);
+        m_maxConcurrentRefreshes = std::max(1, group.readEntry("MaxConcurrentRefreshes", s_defaultConcurrentRefreshes));
     }
 
-    void add(FlatpakRefreshAppstreamMetadataJob *job)
+    // @p urgent when the remote's resources can't be listed until it's refreshed
+    void add(FlatpakRefreshAppstreamMetadataJob *job, bool urgent)
     {
         m_lastProgress = 0;
         m_jobs << job;
-        connect(job, &FlatpakRefreshAppstreamMetadataJob::progressChanged, this, &ProgressCollector::progressChanged);
-        connect(job, &FlatpakRefreshAppstreamMetadataJob::finished, this, [this]() {
-            if (std::ranges::all_of(m_jobs, [](FlatpakRefreshAppstreamMetadataJob *j) {
-                    return j->isFinished();
-                })) {
+        connect(job, &FlatpakRefreshAppstreamMetadataJob::progressChanged, this, &RefreshScheduler::progressChanged);
+        connect(job, &FlatpakRefreshAppstreamMetadataJob::finished, this, [this, job]() {
+            m_running.removeOne(job);
+            m_timings.writeEntry(job->remoteId(), qint64(job->duration().count()));
+            qCDebug(LIBDISCOVER_BACKEND_FLATPAK_LOG) << "refreshed" << job->remoteId() << "in" << job->duration() << "changed:" << job->hasChanged();
+            if (m_backend->m_sources) {
+                m_backend->m_sources->remoteRefreshed(job->installation(), job->remote());
+            }
+            startNext();
+
+            if (m_running.isEmpty() && m_queue.isEmpty()) {
+                m_timings.sync();
                 if (std::ranges::any_of(m_jobs, [](FlatpakRefreshAppstreamMetadataJob *j) -> bool {
                         return j->hasChanged();
                     })) {
@@ -102,6 +121,10 @@ public:
                 Q_EMIT progressChanged();
             }
         });
+
+        const Pending pending = {job, urgent, flatpak_remote_get_prio(job->remote()), refreshTiming(job->remoteId())};
+        m_queue.insert(std::ranges::upper_bound(m_queue, pending, &Pending::before), pending);
+        startNext();
         Q_EMIT progressChanged();
     }
 
@@ -119,13 +142,45 @@ public:
         return m_backend->m_updater->isSettingUp() ? m_lastProgress : 100;
     }
 
+    // How long the last refresh of @p remoteId took, including previous sessions
+    std::chrono::milliseconds refreshTiming(const QString &remoteId) const
+    {
+        return std::chrono::milliseconds(m_timings.readEntry(remoteId, qint64(0)));
+    }
+
 Q_SIGNALS:
     void progressChanged();
 
 private:
+    struct Pending {
+        FlatpakRefreshAppstreamMetadataJob *job;
+        bool urgent;
+        int priority;
+        std::chrono::milliseconds lastDuration;
+
+        static bool before(const Pending &a, const Pending &b)
+        {
+            return std::tuple(!a.urgent, -a.priority, a.lastDuration) < std::tuple(!b.urgent, -b.priority, b.lastDuration);
+        }
+    };
+
+    void startNext()
+    {
+        while (m_running.size() < m_maxConcurrentRefreshes && !m_queue.isEmpty()) {
+            auto job = m_queue.takeFirst().job;
+            m_running << job;
+            job->start();
+        }
+    }
+
+    static constexpr int s_defaultConcurrentRefreshes = 2;
+    int m_maxConcurrentRefreshes = s_defaultConcurrentRefreshes;
     uint m_lastProgress = 0;
     FlatpakBackend *const m_backend;
+    KConfigGroup m_timings;
     QList<FlatpakRefreshAppstreamMetadataJob *> m_jobs;
+    QList<FlatpakRefreshAppstreamMetadataJob *> m_running;
+    QList<Pending> m_queue;
 };
 }
 
@@ -343,12 +398,12 @@ FlatpakBackend::FlatpakBackend(QObject *parent)
     , m_reviews(OdrsReviewsBackend::global())
     , m_cancellable(g_cancellable_new())
     , m_checkForUpdatesTimer(new QTimer(this))
-    , m_collector(new Utils::ProgressCollector(this))
+    , m_scheduler(new Utils::RefreshScheduler(this))
 {
     g_autoptr(GError) error = nullptr;
 
     connect(m_updater, &StandardBackendUpdater::updatesCountChanged, this, &FlatpakBackend::updatesCountChanged);
-    connect(m_collector, &Utils::ProgressCollector::progressChanged, this, &FlatpakBackend::fetchingUpdatesProgressChanged);
+    connect(m_scheduler, &Utils::RefreshScheduler::progressChanged, this, &FlatpakBackend::fetchingUpdatesProgressChanged);
 
     // Load flatpak installation
     if (!setupFlatpakInstallations(&error)) {
@@ -505,7 +560,80 @@ static QString refToBundleId(FlatpakRef *ref)
     return ret;
 }
 
-FlatpakResource *FlatpakBackend::getAppForInstalledRef(FlatpakInstallation *installation, FlatpakInstalledRef *ref, bool *freshResource) const
+// Component describing an installed ref that isn't part of its remote's appstream data
+static AppStream::Component installedRefComponent(FlatpakInstallation *installation, FlatpakInstalledRef *ref, GCancellable *cancellable)
+{
+    g_autoptr(GBytes) metadata = flatpak_installed_ref_load_appdata(ref, cancellable, nullptr);
+    if (metadata) {
+        if (const auto meta = metadataFromBytes(metadata, cancellable)) {
+            const auto components = meta->components();
+            if (components.size() >= 1) {
+                Q_ASSERT(components.size() == 1);
+                return *components.indexSafe(0);
+            }
+        }
+    }
+
+    const QLatin1String name(flatpak_ref_get_name(FLATPAK_REF(ref)));
+    const QString fnDesktop = FlatpakResource::installationPath(installation) + "/exports/share/applications/"_L1 + name + ".desktop"_L1;
+    AppStream::Metadata desktopMetadata;
+    const AppStream::Metadata::MetadataError error = desktopMetadata.parseFile(fnDesktop, AppStream::Metadata::FormatKindDesktopEntry);
+    if (error == AppStream::Metadata::MetadataErrorNoError) {
+        return desktopMetadata.component();
+    }
+    if (QFile::exists(fnDesktop)) {
+        qCDebug(LIBDISCOVER_BACKEND_FLATPAK_LOG) << "Failed to parse appstream metadata:" << error << fnDesktop;
+    }
+
+    AppStream::Component cid;
+    cid.setId(name);
+#if FLATPAK_CHECK_VERSION(1, 1, 2)
+    cid.setName(QString::fromUtf8(flatpak_installed_ref_get_appdata_name(ref)));
+#endif
+    return cid;
+}
+
+// The metadata of an installed ref only changes when a new commit gets deployed,
+// so parsed components are kept on disk keyed by the deploy commit.
+static AppStream::Component cachedInstalledRefComponent(FlatpakInstallation *installation, FlatpakInstalledRef *ref, GCancellable *cancellable)
+{
+    g_autofree char *formattedRef = flatpak_ref_format_ref(FLATPAK_REF(ref));
+    const QByteArray key = FlatpakResource::installationPath(installation).toUtf8() + '/' + formattedRef;
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/flatpak-installed"_L1;
+    const QString prefix = QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex()) + '-'_L1;
+    const QString path = cacheDir + '/'_L1 + prefix + QString::fromUtf8(flatpak_ref_get_commit(FLATPAK_REF(ref))) + ".xml"_L1;
+
+    AppStream::Metadata metadata;
+    if (QFile::exists(path) && metadata.parseFile(path, AppStream::Metadata::FormatKindXml) == AppStream::Metadata::MetadataErrorNoError
+        && metadata.component().isValid()) {
+        return metadata.component();
+    }
+
+    const AppStream::Component component = installedRefComponent(installation, ref, cancellable);
+    if (g_cancellable_is_cancelled(cancellable)) {
+        return component;
+    }
+
+    QDir dir(cacheDir);
+    dir.mkpath(u"."_s);
+    const auto staleEntries = dir.entryList({prefix + '*'_L1}, QDir::Files);
+    for (const QString &stale : staleEntries) {
+        dir.remove(stale);
+    }
+
+    AppStream::Metadata cached;
+    cached.addComponent(component);
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(cached.componentToMetainfo(AppStream::Metadata::FormatKindXml).toUtf8()) < 0 || !file.commit()) {
+        qCDebug(LIBDISCOVER_BACKEND_FLATPAK_LOG) << "Could not cache the installed component" << path << file.errorString();
+    }
+    return component;
+}
+
+FlatpakResource *FlatpakBackend::getAppForInstalledRef(FlatpakInstallation *installation,
+                                                       FlatpakInstalledRef *ref,
+                                                       bool *freshResource,
+                                                       const AppStream::Component &installedComponent) const
 {
     if (freshResource) {
         *freshResource = false;
@@ -521,22 +649,11 @@ FlatpakResource *FlatpakBackend::getAppForInstalledRef(FlatpakInstallation *inst
         }
     }
 
-    const QLatin1String name(flatpak_ref_get_name(FLATPAK_REF(ref)));
-    const QLatin1String branch(flatpak_ref_get_branch(FLATPAK_REF(ref)));
     const QString pathExports = FlatpakResource::installationPath(installation) + QLatin1String("/exports/");
-    const QString pathApps = pathExports + QLatin1String("share/applications/");
     const QString refId = refToBundleId(FLATPAK_REF(ref));
     AppStream::Component cid;
     if (source && source->m_pool) {
-        auto components = source->componentsByFlatpakId(refId);
-        if (components.isEmpty()) {
-            g_autoptr(GBytes) metadata = flatpak_installed_ref_load_appdata(ref, m_cancellable, nullptr);
-            if (metadata) {
-                auto meta = metadataFromBytes(metadata, m_cancellable);
-                components = meta->components();
-            }
-        }
-
+        const auto components = source->componentsByFlatpakId(refId);
         if (components.size() >= 1) {
             Q_ASSERT(components.size() == 1);
             cid = *components.indexSafe(0);
@@ -544,21 +661,7 @@ FlatpakResource *FlatpakBackend::getAppForInstalledRef(FlatpakInstallation *inst
     }
 
     if (!cid.isValid()) {
-        AppStream::Metadata metadata;
-        const QString fnDesktop = pathApps + name + QLatin1String(".desktop");
-        AppStream::Metadata::MetadataError error = metadata.parseFile(fnDesktop, AppStream::Metadata::FormatKindDesktopEntry);
-        if (error != AppStream::Metadata::MetadataErrorNoError) {
-            if (QFile::exists(fnDesktop)) {
-                qCDebug(LIBDISCOVER_BACKEND_FLATPAK_LOG) << "Failed to parse appstream metadata:" << error << fnDesktop;
-            }
-
-            cid.setId(name);
-#if FLATPAK_CHECK_VERSION(1, 1, 2)
-            cid.setName(QString::fromUtf8(flatpak_installed_ref_get_appdata_name(ref)));
-#endif
-        } else {
-            cid = metadata.component();
-        }
+        cid = installedComponent.isValid() ? installedComponent : installedRefComponent(installation, ref, m_cancellable);
     }
 
     if (cid.bundle(AppStream::Bundle::KindFlatpak).isEmpty()) {
@@ -1215,48 +1318,115 @@ QSharedPointer<FlatpakSource> FlatpakBackend::integrateRemote(GLibHolder<Flatpak
     return source;
 }
 
-void FlatpakBackend::loadLocalUpdates()
+namespace
 {
-    acquireFetching(true);
-    for (auto installation : std::as_const(m_installations)) {
-        if (g_cancellable_is_cancelled(m_cancellable)) {
-            break;
-        }
-        loadLocalUpdates(installation);
-    }
-    acquireFetching(false);
+struct LocalUpdate {
+    GLibHolder<FlatpakInstallation> installation;
+    GLibHolder<FlatpakInstalledRef> ref;
+    AppStream::Component component;
+};
 }
-void FlatpakBackend::loadLocalUpdates(FlatpakInstallation *flatpakInstallation)
+
+// Runs on the thread pool, only lists the refs of the flatpak installations
+static QList<LocalUpdate> scanLocalUpdates(const GLibHolder<GCancellable> &cancellable, const QList<GLibHolder<FlatpakInstallation>> &installations)
 {
-    g_autoptr(GError) localError = nullptr;
-    g_autoptr(GPtrArray) refs = flatpak_installation_list_installed_refs(flatpakInstallation, m_cancellable, &localError);
-    if (!refs) {
-        qCWarning(LIBDISCOVER_BACKEND_FLATPAK_LOG) << "Failed to get list of installed refs for listing local updates:" << localError->message;
-        return;
-    }
+    QList<LocalUpdate> ret;
+    for (const auto &installation : installations) {
+        if (g_cancellable_is_cancelled(cancellable.get())) {
+            break;
+        }
 
-    for (uint i = 0; i < refs->len && !g_cancellable_is_cancelled(m_cancellable); i++) {
-        FlatpakInstalledRef *ref = FLATPAK_INSTALLED_REF(g_ptr_array_index(refs, i));
+        g_autoptr(GError) localError = nullptr;
+        g_autoptr(GPtrArray) refs = flatpak_installation_list_installed_refs(installation.get(), cancellable.get(), &localError);
+        if (!refs) {
+            qCWarning(LIBDISCOVER_BACKEND_FLATPAK_LOG) << "Failed to get list of installed refs for listing local updates:" << localError->message;
+            continue;
+        }
 
-        const gchar *latestCommit = flatpak_installed_ref_get_latest_commit(ref);
+        for (uint i = 0; i < refs->len && !g_cancellable_is_cancelled(cancellable.get()); i++) {
+            FlatpakInstalledRef *ref = FLATPAK_INSTALLED_REF(g_ptr_array_index(refs, i));
 
-        if (!latestCommit) {
-            qCWarning(LIBDISCOVER_BACKEND_FLATPAK_LOG) << "Couldn't get latest commit for" << flatpak_ref_get_name(FLATPAK_REF(ref));
-            continue;
+            const gchar *latestCommit = flatpak_installed_ref_get_latest_commit(ref);
+
+            if (!latestCommit) {
+                qCWarning(LIBDISCOVER_BACKEND_FLATPAK_LOG) << "Couldn't get latest commit for" << flatpak_ref_get_name(FLATPAK_REF(ref));
+                continue;
+            }
+
+            const gchar *commit = flatpak_ref_get_commit(FLATPAK_REF(ref));
+            if (g_strcmp0(commit, latestCommit) == 0) {
+                continue;
+            }
+
+            ret.append({installation, GLibHolder(ref), {}});
         }
+    }
+    return ret;
+}
 
-        const gchar *commit = flatpak_ref_get_commit(FLATPAK_REF(ref));
-        if (g_strcmp0(commit, latestCommit) == 0) {
-            continue;
+// Runs on the thread pool, reads the metadata of the refs their remote doesn't know about
+static QList<LocalUpdate> loadLocalUpdateComponents(const GLibHolder<GCancellable> &cancellable, QList<LocalUpdate> updates)
+{
+    for (auto &update : updates) {
+        if (g_cancellable_is_cancelled(cancellable.get())) {
+            break;
         }
+        update.component = cachedInstalledRefComponent(update.installation.get(), update.ref.get(), cancellable.get());
+    }
+    return updates;
+}
 
-        auto resource = getAppForInstalledRef(flatpakInstallation, ref);
+void FlatpakBackend::loadLocalUpdates()
+{
+    acquireFetching(true);
+
+    const auto installations = kTransform<QList<GLibHolder<FlatpakInstallation>>>(m_installations, [](FlatpakInstallation *installation) {
+        return GLibHolder(installation);
+    });
+    auto applyUpdate = [this](const LocalUpdate &update) {
+        auto resource = getAppForInstalledRef(update.installation.get(), update.ref.get(), nullptr, update.component);
         if (resource) {
             resource->setState(AbstractResource::Upgradeable);
             updateAppSize(resource);
+            Q_ASSERT(!resource->temporarySource());
         }
-        Q_ASSERT(!resource->temporarySource());
-    }
+    };
+    auto fw = new QFutureWatcher<QList<LocalUpdate>>(this);
+    connect(fw, &QFutureWatcher<QList<LocalUpdate>>::finished, this, [this, fw, applyUpdate] {
+        fw->deleteLater();
+        const auto updates = fw->result();
+
+        // Most refs are either known already or described by their remote's appstream data,
+        // only the rest needs its own metadata read from disk
+        QList<LocalUpdate> unresolved;
+        for (const auto &update : updates) {
+            const auto source = findSource(update.installation.get(), QString::fromUtf8(flatpak_installed_ref_get_origin(update.ref.get())));
+            if (source
+                && (source->m_resources.contains(idForInstalledRef(update.ref.get(), {}))
+                    || (source->m_pool && !source->componentsByFlatpakId(refToBundleId(FLATPAK_REF(update.ref.get()))).isEmpty()))) {
+                applyUpdate(update);
+            } else {
+                unresolved.append(update);
+            }
+        }
+
+        if (unresolved.isEmpty()) {
+            acquireFetching(false);
+            return;
+        }
+
+        auto componentsWatcher = new QFutureWatcher<QList<LocalUpdate>>(this);
+        connect(componentsWatcher, &QFutureWatcher<QList<LocalUpdate>>::finished, this, [this, componentsWatcher, applyUpdate] {
+            componentsWatcher->deleteLater();
+            const auto updates = componentsWatcher->result();
+            for (const auto &update : updates) {
+                applyUpdate(update);
+            }
+            acquireFetching(false);
+        });
+        componentsWatcher->setFuture(QtConcurrent::run(&m_threadPool, &loadLocalUpdateComponents, GLibHolder(m_cancellable), unresolved));
+    });
+    fw->setFuture(QtConcurrent::run(&m_threadPool, &scanLocalUpdates, GLibHolder(m_cancellable), installations));
 }
 
 bool FlatpakBackend::setupFlatpakInstallations(GError **error)
@@ -1626,7 +1796,7 @@ void triage(FlatpakResource *resource,
 
 int FlatpakBackend::fetchingUpdatesProgress() const
 {
-    return m_collector->progress();
+    return m_scheduler->progress();
 }
 
 ResultsStream *FlatpakBackend::search(const AbstractResourcesBackend::Filters &filter)
@@ -2204,9 +2374,15 @@ void FlatpakBackend::checkForRemoteUpdates(FlatpakInstallation *installation, Fl
         acquireFetching(false);
     });
 
-    m_collector->add(job);
+    // Lists can't show anything from a remote until its pool is loaded
+    const auto source = findSource(installation, QString::fromUtf8(flatpak_remote_get_name(remote)));
+    m_scheduler->add(job, !source || !source->m_pool);
     acquireFetching(true);
-    job->start();
+}
+
+std::chrono::milliseconds FlatpakBackend::remoteRefreshTiming(FlatpakInstallation *installation, FlatpakRemote *remote) const
+{
+    return m_scheduler->refreshTiming(FlatpakRefreshAppstreamMetadataJob::remoteId(installation, remote));
 }
 
 QString FlatpakBackend::displayName() const
@@ -35,7 +35,7 @@ namespace Utils
 {
 /// Useful for when libflatpak returns strings that need to be freed
 QString copyAndFree(char *str);
-class ProgressCollector;
+class RefreshScheduler;
 }
 
 class FlatpakBackend : public AbstractResourcesBackend
@@ -71,7 +71,11 @@ public:
     void addSourceFromFlatpakRepo(const QUrl &url, ResultsStream *stream);
     void addAppFromFlatpakBundle(const QUrl &url, ResultsStream *stream);
     void addAppFromFlatpakRef(const QUrl &url, ResultsStream *stream);
-    FlatpakResource *getAppForInstalledRef(FlatpakInstallation *flatpakInstallation, FlatpakInstalledRef *ref, bool *freshResource = nullptr) const;
+    /// @p installedComponent is used when the ref is not part of its remote's appstream data, it's looked up otherwise
+    FlatpakResource *getAppForInstalledRef(FlatpakInstallation *flatpakInstallation,
+                                           FlatpakInstalledRef *ref,
+                                           bool *freshResource = nullptr,
+                                           const AppStream::Component &installedComponent = {}) const;
 
     FlatpakSourcesBackend *sources() const
     {
@@ -82,6 +86,8 @@ public:
     FlatpakInstalledRef *getInstalledRefForApp(const FlatpakResource *resource) const;
     void loadRemote(FlatpakInstallation *installation, FlatpakRemote *remote);
     void unloadRemote(FlatpakInstallation *installation, FlatpakRemote *remote);
+    /// How long the last AppStream refresh of @p remote took, also from previous sessions
+    std::chrono::milliseconds remoteRefreshTiming(FlatpakInstallation *installation, FlatpakRemote *remote) const;
 
     InlineMessage *explainDysfunction() const override;
 
@@ -125,7 +131,6 @@ private:
     void loadAppsFromAppstreamData();
     bool loadAppsFromAppstreamData(FlatpakInstallation *flatpakInstallation);
     void loadLocalUpdates();
-    void loadLocalUpdates(FlatpakInstallation *flatpakInstallation);
     bool setupFlatpakInstallations(GError **error);
     void updateAppInstalledMetadata(FlatpakInstalledRef *installedRef, FlatpakResource *resource);
     bool updateAppMetadata(FlatpakResource *resource);
@@ -161,6 +166,6 @@ private:
     QSharedPointer<FlatpakSource> m_localSource;
     QTimer *const m_checkForUpdatesTimer;
 
-    friend class Utils::ProgressCollector;
-    Utils::ProgressCollector *const m_collector;
+    friend class Utils::RefreshScheduler;
+    Utils::RefreshScheduler *const m_scheduler;
 };
@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+// SPDX-FileCopyrightText: 2026 Plasma Discover contributors
+
+#include "FlatpakIconLoader.h"
+#include "FlatpakResource.h"
+#include "libdiscover_backend_flatpak_debug.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QSaveFile>
+
+namespace
+{
+constexpr int s_maxConcurrentDownloads = 4;
+} // namespace
+
+FlatpakIconLoader *FlatpakIconLoader::instance()
+{
+    static FlatpakIconLoader loader;
+    return &loader;
+}
+
+QStringList FlatpakIconLoader::localIcons(const QString &iconsDir, const QString &fileName)
+{
+    // "active" points at the current checkout, so a refreshed remote gets a new index
+    const QString canonicalDir = QFileInfo(iconsDir).canonicalFilePath();
+    if (canonicalDir.isEmpty()) {
+        return {};
+    }
+
+    // Replaces the index of the previous checkout, if any
+    auto &index = m_localIcons[iconsDir];
+    if (index.checkout != canonicalDir) {
+        index.checkout = canonicalDir;
+        index.paths.clear();
+        QDirIterator dit(canonicalDir, QDir::Files, QDirIterator::Subdirectories);
+        while (dit.hasNext()) {
+            const QString path = dit.next();
+            index.paths[dit.fileName()] += path;
+        }
+    }
+    return index.paths.value(fileName);
+}
+
+void FlatpakIconLoader::fetch(FlatpakResource *resource, const QUrl &url, const QString &fileName)
+{
+    if (m_failed.contains(url)) {
+        return;
+    }
+
+    auto &waiting = m_waiting[url];
+    if (!waiting.contains(resource)) {
+        waiting += resource;
+    }
+    if (m_active.contains(url)) {
+        return;
+    }
+
+    m_queue.removeIf([&url](const Request &request) {
+        return request.url == url;
+    });
+    m_queue.prepend({url, fileName});
+    startNext();
+}
+
+void FlatpakIconLoader::startNext()
+{
+    if (!m_nam) {
+        m_nam = new QNetworkAccessManager(this);
+        m_nam->setTransferTimeout();
+    }
+
+    while (m_active.size() < s_maxConcurrentDownloads && !m_queue.isEmpty()) {
+        const Request request = m_queue.takeFirst();
+        m_active.insert(request.url);
+
+        auto reply = m_nam->get(QNetworkRequest(request.url));
+        connect(reply, &QNetworkReply::finished, this, [this, reply, fileName = request.fileName] {
+            downloaded(reply, fileName);
+        });
+    }
+}
+
+void FlatpakIconLoader::downloaded(QNetworkReply *reply, const QString &fileName)
+{
+    reply->deleteLater();
+    const QUrl url = reply->request().url();
+    m_active.remove(url);
+
+    bool stored = false;
+    if (reply->error() == QNetworkReply::NoError) {
+        QDir().mkpath(QFileInfo(fileName).absolutePath());
+        QSaveFile file(fileName);
+        stored = file.open(QIODevice::WriteOnly) && file.write(reply->readAll()) >= 0 && file.commit();
+        if (!stored) {
+            qCWarning(LIBDISCOVER_BACKEND_FLATPAK_LOG) << "could not store icon" << fileName << file.errorString();
+        }
+    } else {
+        qCDebug(LIBDISCOVER_BACKEND_FLATPAK_LOG) << "could not fetch icon" << url << reply->errorString();
+    }
+
+    const auto waiting = m_waiting.take(url);
+    if (stored) {
+        for (const auto &resource : waiting) {
+            if (resource) {
+                resource->resolveIcon();
+            }
+        }
+    } else {
+        // Don't try again this session, the resources keep their fallback icon
+        m_failed.insert(url);
+    }
+    startNext();
+}
+
+#include "moc_FlatpakIconLoader.cpp"
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+// SPDX-FileCopyrightText: 2026 Plasma Discover contributors
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QStringList>
+#include <QUrl>
+
+class FlatpakResource;
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// Finds the icons of Flatpak resources. Remote icons are only downloaded once
+// a resource actually asks for its icon, a few at a time and most recent request
+// first. Icons shipped within a remote's appstream data are looked up in a
+// filename index that is built once per appstream checkout.
+class FlatpakIconLoader : public QObject
+{
+    Q_OBJECT
+public:
+    static FlatpakIconLoader *instance();
+
+    // Paths of the icons named @p fileName under the appstream @p iconsDir
+    QStringList localIcons(const QString &iconsDir, const QString &fileName);
+
+    // Downloads @p url into @p fileName, @p resource resolves its icon again once it's there
+    void fetch(FlatpakResource *resource, const QUrl &url, const QString &fileName);
+
+private:
+    using QObject::QObject;
+    void startNext();
+    void downloaded(QNetworkReply *reply, const QString &fileName);
+
+    struct LocalIcons {
+        // Checkout the index was built from
+        QString checkout;
+        // file name -> paths
+        QHash<QString, QStringList> paths;
+    };
+    // icons dir -> its icons
+    QHash<QString, LocalIcons> m_localIcons;
+
+    struct Request {
+        QUrl url;
+        QString fileName;
+    };
+    QList<Request> m_queue;
+    QHash<QUrl, QList<QPointer<FlatpakResource>>> m_waiting;
+    QSet<QUrl> m_active;
+    QSet<QUrl> m_failed;
+    QNetworkAccessManager *m_nam = nullptr;
+};
@@ -10,11 +10,33 @@
 
 #include <glib.h>
 
+#include <KConfigGroup>
+#include <QCryptographicHash>
 #include <QFutureWatcher>
+#include <QStandardPaths>
 #include <QTimer>
 #include <QtConcurrentRun>
 
 using namespace std::chrono_literals;
+using namespace Qt::StringLiterals;
+
+namespace
+{
+// FIXME right now I can't think of any other filter than this, in FlatpakBackend updates are matched
+// with apps so .Locale/.Debug subrefs are not shown and updated automatically. Also this will show
+// updates for refs we don't show in Discover if appstream metadata or desktop file for them is not found
+bool isIgnoredRef(FlatpakRef *ref)
+{
+    const QString refName = QString::fromUtf8(flatpak_ref_get_name(ref));
+    return refName.endsWith(QLatin1String(".Locale")) || refName.endsWith(QLatin1String(".Debug"));
+}
+
+QString formatRef(FlatpakRef *ref)
+{
+    g_autofree char *formatted = flatpak_ref_format_ref(ref);
+    return QString::fromUtf8(formatted);
+}
+} // namespace
 
 static void installationChanged(GFileMonitor *monitor, GFile *child, GFile *other_file, GFileMonitorEvent event_type, gpointer data)
 {
@@ -37,6 +59,7 @@ static void installationChanged(GFileMonitor *monitor, GFile *child, GFile *othe
 FlatpakNotifier::FlatpakNotifier(QObject *parent)
     : BackendNotifierModule(parent)
     , m_cancellable(g_cancellable_new())
+    , m_stateConfig(u"discoverflatpaknotifierstaterc"_s, KConfig::SimpleConfig, QStandardPaths::GenericStateLocation)
 {
     QTimer *dailyCheck = new QTimer(this);
     dailyCheck->setInterval(24h); // refresh at least once every day
@@ -55,6 +78,19 @@ FlatpakNotifier::FlatpakNotifier(QObject *parent)
     if (auto user = flatpak_installation_new_user(m_cancellable, &error)) {
         m_installations << std::make_shared<Installation>(this, user);
     }
+
+    bool loadedState = false;
+    for (const auto &installation : std::as_const(m_installations)) {
+        loadedState |= m_stateConfig.hasGroup(installation->id());
+        loadCachedState(installation);
+    }
+    // The state doesn't say when it was found, the snapshot stored along with it does
+    if (loadedState) {
+        const auto snapshot = UpdatesSnapshot::load().backend(u"flatpak-backend"_s);
+        if (snapshot.isFresh()) {
+            m_cachedStateChecked = snapshot.checked;
+        }
+    }
 }
 
 FlatpakNotifier::Installation::Installation(FlatpakNotifier *notifier, FlatpakInstallation *installation)
@@ -72,6 +108,11 @@ FlatpakNotifier::Installation::~Installation()
         g_object_unref(m_installation);
 }
 
+QString FlatpakNotifier::Installation::id() const
+{
+    return QString::fromUtf8(flatpak_installation_get_id(m_installation));
+}
+
 FlatpakNotifier::~FlatpakNotifier()
 {
     g_object_unref(m_cancellable);
@@ -87,15 +128,30 @@ void FlatpakNotifier::recheckSystemUpdateNeeded()
     }
 }
 
-void FlatpakNotifier::onFetchUpdatesFinished(const std::shared_ptr<Installation> &installation, bool hasUpdates)
+void FlatpakNotifier::onFetchUpdatesFinished(const std::shared_ptr<Installation> &installation, const UpdatesResult &result)
 {
-    if (installation->m_hasUpdates == hasUpdates) {
+    if (result.failed) {
         return;
     }
-    bool hadUpdates = this->hasUpdates();
-    installation->m_hasUpdates = hasUpdates;
 
-    if (hadUpdates != this->hasUpdates()) {
+    installation->m_remoteChecksums = result.remoteChecksums;
+    if (!result.changed) {
+        qCDebug(LIBDISCOVER_BACKEND_FLATPAK_LOG) << "No changes on the remotes of" << installation->id() << ", keeping" << installation->m_updatesCount
+                                                 << "updates";
+        storeSnapshot();
+        return;
+    }
+
+    const bool hadUpdates = this->hasUpdates();
+    const bool countChanged = installation->m_updatesCount != result.count;
+    installation->m_hasUpdates = result.count > 0;
+    installation->m_updatesCount = result.count;
+    installation->m_downloadSize = result.downloadSize;
+    installation->m_updates = result.updates;
+    storeCachedState(installation);
+    storeSnapshot();
+
+    if (hadUpdates != this->hasUpdates() || (countChanged && installation->m_hasUpdates)) {
         Q_EMIT foundUpdates();
     }
 }
@@ -103,36 +159,164 @@ void FlatpakNotifier::onFetchUpdatesFinished(const std::shared_ptr<Installation>
 void FlatpakNotifier::loadRemoteUpdates(const std::shared_ptr<Installation> &installation)
 {
     Q_ASSERT(installation->m_installation);
-    auto fw = new QFutureWatcher<bool>(this);
-    connect(fw, &QFutureWatcher<bool>::finished, this, [this, installation, fw]() {
+    auto fw = new QFutureWatcher<UpdatesResult>(this);
+    connect(fw, &QFutureWatcher<UpdatesResult>::finished, this, [this, installation, fw]() {
         onFetchUpdatesFinished(installation, fw->result());
         fw->deleteLater();
     });
-    fw->setFuture(QtConcurrent::run([installation]() -> bool {
+    fw->setFuture(QtConcurrent::run([installation, previousChecksums = installation->m_remoteChecksums]() -> UpdatesResult {
         g_autoptr(GCancellable) cancellable = g_cancellable_new();
         g_autoptr(GError) localError = nullptr;
-        g_autoptr(GPtrArray) fetchedUpdates = flatpak_installation_list_installed_refs_for_update(installation->m_installation, cancellable, &localError);
-        bool hasUpdates = false;
+        UpdatesResult result;
+
+        g_autoptr(GPtrArray) installedRefs = flatpak_installation_list_installed_refs(installation->m_installation, cancellable, &localError);
+        if (!installedRefs) {
+            qCWarning(LIBDISCOVER_BACKEND_FLATPAK_LOG) << "Failed to get list of installed refs:" << localError->message;
+            result.failed = true;
+            return result;
+        }
+
+        // remote -> (formatted ref -> installed commit)
+        QHash<QString, QHash<QString, QByteArray>> installedByRemote;
+        for (uint i = 0; i < installedRefs->len; i++) {
+            FlatpakInstalledRef *ref = FLATPAK_INSTALLED_REF(g_ptr_array_index(installedRefs, i));
+            const QString origin = QString::fromUtf8(flatpak_installed_ref_get_origin(ref));
+            installedByRemote[origin].insert(formatRef(FLATPAK_REF(ref)), QByteArray(flatpak_ref_get_commit(FLATPAK_REF(ref))));
+        }
+
+        // Fetching the summary is conditional on it having changed upstream, flatpak keeps it cached otherwise.
+        // We only get to compute the actual update set when either the remote or the installed commits differ
+        // from the last time we checked.
+        QHash<QString, quint64> downloadSizes;
+        for (auto it = installedByRemote.cbegin(), itEnd = installedByRemote.cend(); it != itEnd; ++it) {
+            const QByteArray remoteName = it.key().toUtf8();
+            g_autoptr(GError) remoteError = nullptr;
+            g_autoptr(GPtrArray) remoteRefs = flatpak_installation_list_remote_refs_sync_full(installation->m_installation,
+                                                                                              remoteName.constData(),
+                                                                                              FLATPAK_QUERY_FLAGS_NONE,
+                                                                                              cancellable,
+                                                                                              &remoteError);
+            if (!remoteRefs) {
+                // Leave it without checksum so we fall back to the thorough check
+                qCDebug(LIBDISCOVER_BACKEND_FLATPAK_LOG) << "Could not list refs for" << it.key() << (remoteError ? remoteError->message : "");
+                result.changed = true;
+                continue;
+            }
+
+            QHash<QString, QByteArray> remoteCommits;
+            for (uint i = 0; i < remoteRefs->len; i++) {
+                FlatpakRemoteRef *ref = FLATPAK_REMOTE_REF(g_ptr_array_index(remoteRefs, i));
+                const QString formatted = formatRef(FLATPAK_REF(ref));
+                if (!it->contains(formatted)) {
+                    continue;
+                }
+                remoteCommits.insert(formatted, QByteArray(flatpak_ref_get_commit(FLATPAK_REF(ref))));
+                downloadSizes.insert(formatted, flatpak_remote_ref_get_download_size(ref));
+            }
+
+            QStringList refs = it->keys();
+            refs.sort();
+            QCryptographicHash hash(QCryptographicHash::Sha256);
+            for (const QString &ref : std::as_const(refs)) {
+                hash.addData(ref.toUtf8());
+                hash.addData(it->value(ref));
+                hash.addData(remoteCommits.value(ref));
+            }
+            const QByteArray checksum = hash.result();
+            result.remoteChecksums.insert(it.key(), checksum);
+            if (previousChecksums.value(it.key()) != checksum) {
+                result.changed = true;
+            }
+        }
+        if (previousChecksums.size() != result.remoteChecksums.size()) {
+            result.changed = true;
+        }
 
+        if (!result.changed) {
+            return result;
+        }
+
+        g_autoptr(GPtrArray) fetchedUpdates = flatpak_installation_list_installed_refs_for_update(installation->m_installation, cancellable, &localError);
         if (!fetchedUpdates) {
             qCWarning(LIBDISCOVER_BACKEND_FLATPAK_LOG) << "Failed to get list of installed refs for listing updates: " << localError->message;
-            return false;
+            result.failed = true;
+            return result;
         }
-        for (uint i = 0; !hasUpdates && i < fetchedUpdates->len; i++) {
+        for (uint i = 0; i < fetchedUpdates->len; i++) {
             FlatpakInstalledRef *ref = FLATPAK_INSTALLED_REF(g_ptr_array_index(fetchedUpdates, i));
-            const QString refName = QString::fromUtf8(flatpak_ref_get_name(FLATPAK_REF(ref)));
-            // FIXME right now I can't think of any other filter than this, in FlatpakBackend updates are matched
-            // with apps so .Locale/.Debug subrefs are not shown and updated automatically. Also this will show
-            // updates for refs we don't show in Discover if appstream metadata or desktop file for them is not found
-            if (refName.endsWith(QLatin1String(".Locale")) || refName.endsWith(QLatin1String(".Debug"))) {
+            if (isIgnoredRef(FLATPAK_REF(ref))) {
                 continue;
             }
-            hasUpdates = true;
+            const QString formatted = formatRef(FLATPAK_REF(ref));
+            const quint64 downloadSize = downloadSizes.value(formatted);
+            result.count++;
+            result.downloadSize += downloadSize;
+            result.updates.append({.id = formatted, .downloadSize = downloadSize});
         }
-        return hasUpdates;
+        return result;
     }));
 }
 
+int FlatpakNotifier::updatesCount() const
+{
+    int ret = 0;
+    for (const auto &installation : m_installations) {
+        ret += installation->m_updatesCount;
+    }
+    return ret;
+}
+
+quint64 FlatpakNotifier::updatesDownloadSize() const
+{
+    quint64 ret = 0;
+    for (const auto &installation : m_installations) {
+        ret += installation->m_downloadSize;
+    }
+    return ret;
+}
+
+void FlatpakNotifier::storeSnapshot()
+{
+    UpdatesSnapshot::Backend backend;
+    backend.checked = QDateTime::currentDateTimeUtc();
+    for (const auto &installation : std::as_const(m_installations)) {
+        backend.updates += installation->m_updates;
+    }
+    backend.summarize();
+    // We only know the count of the installations we restored from the cache
+    backend.count = updatesCount();
+    backend.downloadSize = updatesDownloadSize();
+    UpdatesSnapshot::store(u"flatpak-backend"_s, backend);
+}
+
+void FlatpakNotifier::loadCachedState(const std::shared_ptr<Installation> &installation)
+{
+    const KConfigGroup group = m_stateConfig.group(installation->id());
+    installation->m_updatesCount = group.readEntry("UpdatesCount", 0);
+    installation->m_downloadSize = group.readEntry("DownloadSize", quint64(0));
+    installation->m_hasUpdates = installation->m_updatesCount > 0;
+
+    const KConfigGroup remotesGroup = group.group(u"Remotes"_s);
+    const auto remotes = remotesGroup.keyList();
+    for (const QString &remote : remotes) {
+        installation->m_remoteChecksums.insert(remote, QByteArray::fromHex(remotesGroup.readEntry(remote, QByteArray())));
+    }
+}
+
+void FlatpakNotifier::storeCachedState(const std::shared_ptr<Installation> &installation)
+{
+    KConfigGroup group = m_stateConfig.group(installation->id());
+    group.writeEntry("UpdatesCount", installation->m_updatesCount);
+    group.writeEntry("DownloadSize", installation->m_downloadSize);
+
+    KConfigGroup remotesGroup = group.group(u"Remotes"_s);
+    remotesGroup.deleteGroup();
+    for (auto it = installation->m_remoteChecksums.cbegin(), itEnd = installation->m_remoteChecksums.cend(); it != itEnd; ++it) {
+        remotesGroup.writeEntry(it.key(), it->toHex());
+    }
+    m_stateConfig.sync();
+}
+
 bool FlatpakNotifier::hasUpdates()
 {
     return std::ranges::any_of(m_installations, [](const auto &installation) {
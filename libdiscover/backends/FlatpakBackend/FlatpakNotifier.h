@@ -7,6 +7,9 @@
 #pragma once
 
 #include <BackendNotifierModule.h>
+#include <KConfig>
+#include <UpdatesSnapshot.h>
+#include <QHash>
 #include <functional>
 
 #include "flatpak-helper.h"
@@ -30,6 +33,15 @@ public:
     {
         return false;
     }
+    QDateTime cachedStateChecked() const override
+    {
+        return m_cachedStateChecked;
+    }
+
+    /** @returns how many refs can be updated across all installations */
+    int updatesCount() const;
+    /** @returns the accumulated download size of all the available updates, in bytes */
+    quint64 updatesDownloadSize() const;
 
     struct Installation {
         explicit Installation(FlatpakNotifier *notifier, FlatpakInstallation *installation);
@@ -37,17 +49,37 @@ public:
         Q_DISABLE_COPY(Installation);
 
         bool ensureInitialized(GCancellable *);
+        QString id() const;
 
         FlatpakNotifier *const m_notifier;
         bool m_hasUpdates = false;
+        int m_updatesCount = 0;
+        quint64 m_downloadSize = 0;
+        QList<UpdatesSnapshot::Update> m_updates;
+        /// remote name -> checksum of the installed and remote commits of the refs it provides
+        QHash<QString, QByteArray> m_remoteChecksums;
         GFileMonitor *m_monitor = nullptr;
         FlatpakInstallation *const m_installation;
     };
 
-    void onFetchUpdatesFinished(const std::shared_ptr<Installation> &flatpakInstallation, bool hasUpdates);
+    struct UpdatesResult {
+        bool failed = false;
+        bool changed = false;
+        int count = 0;
+        quint64 downloadSize = 0;
+        QList<UpdatesSnapshot::Update> updates;
+        QHash<QString, QByteArray> remoteChecksums;
+    };
+
+    void onFetchUpdatesFinished(const std::shared_ptr<Installation> &flatpakInstallation, const UpdatesResult &result);
     void loadRemoteUpdates(const std::shared_ptr<Installation> &installation);
     void setupFlatpakInstallations();
+    void loadCachedState(const std::shared_ptr<Installation> &installation);
+    void storeCachedState(const std::shared_ptr<Installation> &installation);
+    void storeSnapshot();
     QList<std::shared_ptr<Installation>> m_installations;
     GCancellable *const m_cancellable;
     bool m_lastHasUpdates = false;
+    KConfig m_stateConfig;
+    QDateTime m_cachedStateChecked;
 };
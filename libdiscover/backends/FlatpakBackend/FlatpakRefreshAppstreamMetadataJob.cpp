@@ -8,6 +8,10 @@
 #include "FlatpakRefreshAppstreamMetadataJob.h"
 #include "libdiscover_backend_flatpak_debug.h"
 
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+
 FlatpakRefreshAppstreamMetadataJob::FlatpakRefreshAppstreamMetadataJob(FlatpakInstallation *installation, FlatpakRemote *remote)
     : QThread()
     , m_cancellable(g_cancellable_new())
@@ -36,9 +40,34 @@ void FlatpakRefreshAppstreamMetadataJob::updateCallback(const char *status, guin
     Q_EMIT self->progressChanged();
 }
 
+QString FlatpakRefreshAppstreamMetadataJob::remoteId() const
+{
+    return remoteId(m_installation.get(), m_remote.get());
+}
+
+QString FlatpakRefreshAppstreamMetadataJob::remoteId(FlatpakInstallation *installation, FlatpakRemote *remote)
+{
+    return QString::fromUtf8(flatpak_installation_get_id(installation)) + QLatin1Char('/') + QString::fromUtf8(flatpak_remote_get_name(remote));
+}
+
+// The active AppStream checkout is a symlink named after the commit it was pulled from,
+// so it tells whether the AppStream listed in the remote's summary is the one we have.
+QByteArray FlatpakRefreshAppstreamMetadataJob::appstreamCommit() const
+{
+    g_autoptr(GFile) appstreamDir = flatpak_remote_get_appstream_dir(m_remote.get(), nullptr);
+    if (!appstreamDir) {
+        return {};
+    }
+    g_autofree char *path = g_file_get_path(appstreamDir);
+    return QFileInfo(QFileInfo(QFile::decodeName(path)).symLinkTarget()).fileName().toLatin1();
+}
+
 void FlatpakRefreshAppstreamMetadataJob::run()
 {
     g_autoptr(GError) localError = nullptr;
+    QElapsedTimer timer;
+    timer.start();
+    const QByteArray previousCommit = appstreamCommit();
 
     gboolean changed = false;
     if (!flatpak_installation_update_appstream_full_sync(m_installation.get(),
@@ -53,6 +82,15 @@ void FlatpakRefreshAppstreamMetadataJob::run()
         qCWarning(LIBDISCOVER_BACKEND_FLATPAK_LOG).nospace()
             << "Failed to refresh appstream metadata for " << flatpak_remote_get_name(m_remote.get()) << ": " << error;
     }
+    m_duration = std::chrono::milliseconds(timer.elapsed());
+
+    // Reloading the pools and rescanning for updates is only worth it when the commit
+    // the summary points to moved, fall back to flatpak's word when we can't tell.
+    const QByteArray commit = appstreamCommit();
+    if (changed && !previousCommit.isEmpty() && commit == previousCommit) {
+        qCDebug(LIBDISCOVER_BACKEND_FLATPAK_LOG) << "AppStream unchanged for" << remoteId() << commit;
+        changed = false;
+    }
     m_hasChanged = changed;
     Q_EMIT jobRefreshAppstreamMetadataFinished(m_installation, m_remote, changed);
 }
@@ -10,6 +10,8 @@
 #include "flatpak-helper.h"
 #include <QThread>
 
+#include <chrono>
+
 template<typename T>
 class GLibHolder
 {
@@ -22,7 +24,9 @@ public:
 
     ~GLibHolder()
     {
-        g_object_unref(m_object);
+        if (m_object) {
+            g_object_unref(m_object);
+        }
     }
 
     GLibHolder(const GLibHolder &other)
@@ -68,12 +72,31 @@ public:
         return m_hasChanged != 0;
     }
 
+    FlatpakInstallation *installation() const
+    {
+        return m_installation.get();
+    }
+    FlatpakRemote *remote() const
+    {
+        return m_remote.get();
+    }
+    /// Identifies the remote across installations, e.g. "user/flathub"
+    QString remoteId() const;
+    static QString remoteId(FlatpakInstallation *installation, FlatpakRemote *remote);
+
+    /// How long the refresh took, only valid once finished
+    std::chrono::milliseconds duration() const
+    {
+        return m_duration;
+    }
+
 Q_SIGNALS:
     void progressChanged();
     void jobRefreshAppstreamMetadataFinished(GLibHolder<FlatpakInstallation> installation, GLibHolder<FlatpakRemote> remote, bool changed);
 
 private:
     static void updateCallback(const char *status, guint progress, gboolean estimating, gpointer user_data);
+    QByteArray appstreamCommit() const;
 
     GCancellable *m_cancellable;
     GLibHolder<FlatpakInstallation> m_installation;
@@ -81,4 +104,5 @@ private:
     QAtomicInt m_progress = 0;
     QAtomicInt m_estimating = true;
     QAtomicInt m_hasChanged = false;
+    std::chrono::milliseconds m_duration = {};
 };
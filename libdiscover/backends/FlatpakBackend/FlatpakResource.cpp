@@ -8,6 +8,7 @@
 #include "FlatpakResource.h"
 #include "FlatpakBackend.h"
 #include "FlatpakFetchDataJob.h"
+#include "FlatpakIconLoader.h"
 #include "FlatpakSourcesBackend.h"
 #include "LazyIconResolver.h"
 #include "config-paths.h"
@@ -34,14 +35,10 @@
 #include <QCoroCore>
 #include <QDesktopServices>
 #include <QDir>
-#include <QDirIterator>
 #include <QEvent>
 #include <QFileInfo>
 #include <QFutureWatcher>
 #include <QIcon>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
-#include <QNetworkRequest>
 #include <QProcess>
 #include <QQueue>
 #include <QStringList>
@@ -66,8 +63,6 @@ const QStringList FlatpakResource::s_topObjects({
 });
 const QStringList FlatpakResource::s_bottomObjects({QStringLiteral("qrc:/qml/PermissionsList.qml")});
 
-Q_GLOBAL_STATIC(QNetworkAccessManager, manager)
-
 FlatpakResource::FlatpakResource(const AppStream::Component &component, FlatpakInstallation *installation, FlatpakBackend *parent)
     : AbstractResource(parent)
     , m_appdata(component)
@@ -80,7 +75,6 @@ FlatpakResource::FlatpakResource(const AppStream::Component &component, FlatpakI
 {
     setObjectName(packageName());
 
-    // Start fetching remote icons during initialization
     const auto icons = m_appdata.icons();
     m_stockIcon = std::ranges::any_of(icons, [](const AppStream::Icon &icon) {
         return icon.kind() == AppStream::Icon::KindStock && AppStreamUtils::kIconLoaderHasIcon(icon.name());
@@ -88,38 +82,6 @@ FlatpakResource::FlatpakResource(const AppStream::Component &component, FlatpakI
     connect(this, &AbstractResource::iconChanged, this, [this] {
         Q_EMIT backend()->resourcesChanged(this, {"icon"});
     });
-    if (!m_stockIcon && !icons.isEmpty() && !std::ranges::any_of(icons, [](const AppStream::Icon &icon) {
-            return icon.kind() == AppStream::Icon::KindLocal || icon.kind() == AppStream::Icon::KindCached;
-        })) {
-        for (const auto &icon : icons) {
-            if (icon.kind() != AppStream::Icon::KindRemote) {
-                continue;
-            }
-            const QString fileName = iconCachePath(icon);
-            if (!QFileInfo::exists(fileName)) {
-                const QDir cacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
-                // Create $HOME/.cache/discover/icons folder
-                cacheDir.mkdir(QStringLiteral("icons"));
-                auto reply = manager->get(QNetworkRequest(icon.url()));
-                connect(reply, &QNetworkReply::finished, this, [this, icon, fileName, reply] {
-                    if (reply->error() == QNetworkReply::NoError) {
-                        QByteArray iconData = reply->readAll();
-                        QFile file(fileName);
-                        if (file.open(QIODevice::WriteOnly)) {
-                            file.write(iconData);
-                        } else {
-                            qCDebug(LIBDISCOVER_BACKEND_FLATPAK_LOG) << "could not find icon for" << packageName() << reply->url();
-                            QIcon::fromTheme(QStringLiteral("package-x-generic")).pixmap(32, 32).toImage().save(fileName);
-                        }
-                        file.close();
-                        Q_EMIT iconChanged();
-                        reply->deleteLater();
-                    }
-                });
-            }
-        }
-    }
-
     connect(this, &FlatpakResource::stateChanged, this, &FlatpakResource::hasDataChanged);
 }
 
@@ -233,6 +195,8 @@ void FlatpakResource::resolveIcon()
     } else if (icons.isEmpty()) {
         m_icon = QIcon::fromTheme(QStringLiteral("package-x-generic"));
     } else {
+        // Remote icons are only downloaded when nothing local is usable, and then just one of them
+        std::optional<AppStream::Icon> missingRemoteIcon;
         for (const AppStream::Icon &icon : icons) {
             switch (icon.kind()) {
             case AppStream::Icon::KindLocal:
@@ -241,12 +205,9 @@ void FlatpakResource::resolveIcon()
                 if (QDir::isRelativePath(path)) {
                     const QString appstreamLocation =
                         installationPath() + "/appstream/"_L1 + origin() + '/'_L1 + QString::fromUtf8(flatpak_get_default_arch()) + "/active/icons/"_L1;
-                    QDirIterator dit(appstreamLocation, QDirIterator::Subdirectories);
-                    while (dit.hasNext()) {
-                        const auto currentPath = dit.next();
-                        if (dit.fileName() == path) {
-                            m_icon->addFile(currentPath, icon.size());
-                        }
+                    const QStringList paths = FlatpakIconLoader::instance()->localIcons(appstreamLocation, path);
+                    for (const QString &currentPath : paths) {
+                        m_icon->addFile(currentPath, icon.size());
                     }
                 } else {
                     m_icon->addFile(path, icon.size());
@@ -263,6 +224,8 @@ void FlatpakResource::resolveIcon()
                 const QString fileName = iconCachePath(icon);
                 if (QFileInfo::exists(fileName)) {
                     m_icon->addFile(fileName, icon.size());
+                } else if (!missingRemoteIcon) {
+                    missingRemoteIcon = icon;
                 }
                 break;
             }
@@ -270,6 +233,10 @@ void FlatpakResource::resolveIcon()
                 break;
             }
         }
+
+        if (m_icon->isNull() && missingRemoteIcon) {
+            FlatpakIconLoader::instance()->fetch(this, missingRemoteIcon->url(), iconCachePath(*missingRemoteIcon));
+        }
     }
 
     if (m_icon->isNull()) {
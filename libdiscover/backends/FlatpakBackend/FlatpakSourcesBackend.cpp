@@ -11,6 +11,7 @@
 #include "libdiscover_backend_flatpak_debug.h"
 
 #include <KConfigGroup>
+#include <KFormat>
 #include <KLocalizedString>
 #include <KSharedConfig>
 #include <QNetworkAccessManager>
@@ -85,6 +86,19 @@ public:
         return m_remote;
     }
 
+    void updateToolTip()
+    {
+        const QUrl remoteUrl = data(Qt::StatusTipRole).toUrl();
+        const QString location = remoteUrl.isLocalFile() ? remoteUrl.toLocalFile() : remoteUrl.host();
+        const auto timing = m_backend->remoteRefreshTiming(m_installation, m_remote);
+        if (timing.count() > 0) {
+            setData(i18nc("@info:tooltip %1 is the remote's location", "%1\nLast refreshed in %2", location, KFormat().formatDuration(timing.count())),
+                    Qt::ToolTipRole);
+        } else {
+            setData(location, Qt::ToolTipRole);
+        }
+    }
+
 private:
     FlatpakInstallation *m_installation = nullptr;
     FlatpakRemote *const m_remote;
@@ -370,7 +384,6 @@ void FlatpakSourcesBackend::addRemote(FlatpakRemote *remote, FlatpakInstallation
     auto backend = qobject_cast<FlatpakBackend *>(parent());
     auto it = new FlatpakSourceItem(label, remote, backend);
     const int prio = flatpak_remote_get_prio(remote);
-    it->setData(remoteUrl.isLocalFile() ? remoteUrl.toLocalFile() : remoteUrl.host(), Qt::ToolTipRole);
     it->setData(remoteUrl, Qt::StatusTipRole);
     it->setData(id, IdRole);
     it->setData(disambiguatedId, DisambiguatedIdRole);
@@ -381,6 +394,7 @@ void FlatpakSourcesBackend::addRemote(FlatpakRemote *remote, FlatpakInstallation
 #endif
     it->setCheckable(true);
     it->setFlatpakInstallation(installation);
+    it->updateToolTip();
 
     // Add the remotes before those with lower priorities, after the rest.
     // We disambiguate with internal discover settings
@@ -445,6 +459,23 @@ int FlatpakSourcesBackend::originIndex(const QString &disambiguatedSourceId) con
     return item ? item->row() : INT_MAX;
 }
 
+void FlatpakSourcesBackend::remoteRefreshed(FlatpakInstallation *installation, FlatpakRemote *remote)
+{
+    const QString name = QString::fromUtf8(flatpak_remote_get_name(remote));
+    for (int i = 0, c = m_sources->rowCount(); i < c; ++i) {
+        auto item = m_sources->item(i);
+        if (item == m_noSourcesItem) {
+            continue;
+        }
+
+        auto sourceItem = static_cast<FlatpakSourceItem *>(item);
+        if (sourceItem->flatpakInstallation() == installation && sourceItem->data(IdRole).toString() == name) {
+            sourceItem->updateToolTip();
+            return;
+        }
+    }
+}
+
 void FlatpakSourcesBackend::cancel()
 {
     m_proceedFunctions.pop();
@@ -62,6 +62,8 @@ public:
 
     void save();
     void addRemote(FlatpakRemote *remote, FlatpakInstallation *installation);
+    /// Shows how long the last refresh of @p remote took
+    void remoteRefreshed(FlatpakInstallation *installation, FlatpakRemote *remote);
 
 private:
     FlatpakInstallation *m_preferredInstallation;
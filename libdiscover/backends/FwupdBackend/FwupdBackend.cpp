@@ -23,6 +23,8 @@
 #include <KSharedConfig>
 #include <QCoreApplication>
 
+#include <memory>
+
 DISCOVER_BACKEND_PLUGIN(FwupdBackend)
 
 FwupdBackend::FwupdBackend(QObject *parent)
@@ -101,75 +103,51 @@ FwupdResource *FwupdBackend::createRelease(FwupdDevice *device)
     return res;
 }
 
-void FwupdBackend::addUpdates()
+void FwupdBackend::setUpgrades(FwupdDevice *device, GPtrArray *rels, GError *error)
 {
-    g_autoptr(GError) error = nullptr;
-    g_autoptr(GPtrArray) devices = fwupd_client_get_devices(client, m_cancellable, &error);
-
-    if (!devices) {
-        if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_NOTHING_TO_DO))
-            qDebug() << "Fwupd Info: No Devices Found";
-        else
+    if (!rels) {
+        if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED)) {
+            qWarning() << "fwupd: Device not supported:" << fwupd_device_get_name(device);
+        } else if (!g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_NOTHING_TO_DO)) {
             handleError(error);
+        }
         return;
     }
 
-    for (uint i = 0; i < devices->len && !g_cancellable_is_cancelled(m_cancellable); i++) {
-        FwupdDevice *device = (FwupdDevice *)g_ptr_array_index(devices, i);
-
-        if (!fwupd_device_has_flag(device, FWUPD_DEVICE_FLAG_SUPPORTED))
-            continue;
+    if ((fwupd_device_get_flags(device) & FWUPD_DEVICE_FLAG_NEEDS_REBOOT) && fwupd_device_get_update_state(device) == FWUPD_UPDATE_STATE_SUCCESS) {
+        m_updater->setNeedsReboot(true);
+        return;
+    }
 
-        if (fwupd_device_has_flag(device, FWUPD_DEVICE_FLAG_LOCKED))
-            continue;
+    fwupd_device_add_release(device, (FwupdRelease *)g_ptr_array_index(rels, 0));
+    auto res = createApp(device);
+    if (!res) {
+        qWarning() << "Fwupd Error: Cannot Create App From Device" << fwupd_device_get_name(device);
+        return;
+    }
 
-        if (!fwupd_device_has_flag(device, FWUPD_DEVICE_FLAG_UPDATABLE))
+    QString longdescription;
+    for (uint j = 0; j < rels->len; j++) {
+        FwupdRelease *release = (FwupdRelease *)g_ptr_array_index(rels, j);
+        if (!fwupd_release_get_description(release))
             continue;
-
-        g_autoptr(GError) error2 = nullptr;
-        g_autoptr(GPtrArray) rels = fwupd_client_get_upgrades(client, fwupd_device_get_id(device), m_cancellable, &error2);
-        if (rels) {
-            if ((fwupd_device_get_flags(device) & FWUPD_DEVICE_FLAG_NEEDS_REBOOT) && fwupd_device_get_update_state(device) == FWUPD_UPDATE_STATE_SUCCESS) {
-                m_updater->setNeedsReboot(true);
-                continue;
-            }
-
-            fwupd_device_add_release(device, (FwupdRelease *)g_ptr_array_index(rels, 0));
-            auto res = createApp(device);
-            if (!res) {
-                qWarning() << "Fwupd Error: Cannot Create App From Device" << fwupd_device_get_name(device);
-            } else {
-                QString longdescription;
-                for (uint j = 0; j < rels->len; j++) {
-                    FwupdRelease *release = (FwupdRelease *)g_ptr_array_index(rels, j);
-                    if (!fwupd_release_get_description(release))
-                        continue;
-                    if (rels->len > 1) {
-                        longdescription += QStringLiteral("Version %1\n").arg(QString::fromUtf8(fwupd_release_get_version(release)));
-                    }
-                    longdescription += QString::fromUtf8(fwupd_release_get_description(release));
-                    if (rels->len > 1) {
-                        longdescription += QLatin1Char('\n');
-                    }
-                }
-                res->setDescription(longdescription);
-
-                // Make sure to set the installed version of the current thing so
-                // they can both be shown in the update page UI
-                auto installedResource = m_resources[res->packageName()];
-                if (installedResource) {
-                    res->setInstalledVersion(installedResource->availableVersion());
-                }
-                addResource(res);
-            }
-        } else {
-            if (g_error_matches(error2, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED)) {
-                qWarning() << "fwupd: Device not supported:" << fwupd_device_get_name(device);
-            } else if (!g_error_matches(error2, FWUPD_ERROR, FWUPD_ERROR_NOTHING_TO_DO)) {
-                handleError(error2);
-            }
+        if (rels->len > 1) {
+            longdescription += QStringLiteral("Version %1\n").arg(QString::fromUtf8(fwupd_release_get_version(release)));
         }
+        longdescription += QString::fromUtf8(fwupd_release_get_description(release));
+        if (rels->len > 1) {
+            longdescription += QLatin1Char('\n');
+        }
+    }
+    res->setDescription(longdescription);
+
+    // Make sure to set the installed version of the current thing so
+    // they can both be shown in the update page UI
+    auto installedResource = m_resources[res->packageName()];
+    if (installedResource) {
+        res->setInstalledVersion(installedResource->availableVersion());
     }
+    addResource(res);
 }
 
 QByteArray FwupdBackend::getChecksum(const QString &filename, QCryptographicHash::Algorithm hashAlgorithm)
@@ -229,13 +207,21 @@ FwupdResource *FwupdBackend::createApp(FwupdDevice *device)
 
     /* Checking for firmware in the cache? */
     const QString filename_cache = app->cacheFile();
-    if (QFile::exists(filename_cache)) {
+    const QFileInfo cachedInfo(filename_cache);
+    if (cachedInfo.exists()) {
         /* Currently LVFS supports SHA1 only*/
         const QByteArray checksum_tmp(fwupd_checksum_get_by_kind(checksums, G_CHECKSUM_SHA1));
-        const QByteArray checksum = getChecksum(filename_cache, QCryptographicHash::Sha1);
-        if (checksum_tmp != checksum) {
-            QFile::remove(filename_cache);
-        }
+        // Cabinet files can be large, hash them off the main thread. The file may be downloaded
+        // again meanwhile, only remove it if it's still the one that was hashed.
+        const qint64 size = cachedInfo.size();
+        const QDateTime modified = cachedInfo.lastModified();
+        QtConcurrent::run(getChecksum, filename_cache, QCryptographicHash::Sha1)
+            .then(this, [filename_cache, checksum_tmp, size, modified](const QByteArray &checksum) {
+                const QFileInfo info(filename_cache);
+                if (checksum_tmp != checksum && info.exists() && info.size() == size && info.lastModified() == modified) {
+                    QFile::remove(filename_cache);
+                }
+            });
     }
 
     app->setState(AbstractResource::Upgradeable);
@@ -278,52 +264,118 @@ static void fwupd_client_get_devices_cb(GObject * /*source*/, GAsyncResult *res,
     FwupdBackend *helper = (FwupdBackend *)user_data;
     g_autoptr(GError) error = nullptr;
     auto array = fwupd_client_get_devices_finish(helper->client, res, &error);
-    if (!error)
+    if (!error) {
         helper->setDevices(array);
-    else
+    } else {
         helper->handleError(error);
+        helper->setDevices(nullptr);
+    }
+}
+
+/* Tracks a device while its releases and upgrades are queried */
+struct FwupdDeviceRequest {
+    FwupdBackend *backend;
+    FwupdDevice *device;
+
+    ~FwupdDeviceRequest()
+    {
+        g_object_unref(device);
+    }
+};
+
+static void fwupd_client_get_upgrades_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+    std::unique_ptr<FwupdDeviceRequest> request((FwupdDeviceRequest *)user_data);
+    g_autoptr(GError) error = nullptr;
+    g_autoptr(GPtrArray) upgrades = fwupd_client_get_upgrades_finish(FWUPD_CLIENT(source), res, &error);
+    if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        // The backend is gone
+        return;
+    }
+    request->backend->setUpgrades(request->device, upgrades, error);
+    request->backend->deviceResolved();
+}
+
+static void fwupd_client_get_releases_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+    std::unique_ptr<FwupdDeviceRequest> request((FwupdDeviceRequest *)user_data);
+    g_autoptr(GError) error = nullptr;
+    g_autoptr(GPtrArray) releases = fwupd_client_get_releases_finish(FWUPD_CLIENT(source), res, &error);
+    if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        return;
+    }
+
+    FwupdBackend *backend = request->backend;
+    FwupdDevice *device = request->device;
+    backend->setReleases(device, releases, error);
+
+    // Only then look for upgrades, they need the installed release to be known
+    if (fwupd_device_has_flag(device, FWUPD_DEVICE_FLAG_LOCKED) || !fwupd_device_has_flag(device, FWUPD_DEVICE_FLAG_UPDATABLE)) {
+        backend->deviceResolved();
+        return;
+    }
+    fwupd_client_get_upgrades_async(backend->client, fwupd_device_get_id(device), backend->cancellable(), fwupd_client_get_upgrades_cb, request.release());
 }
 
 void FwupdBackend::setDevices(GPtrArray *devices)
 {
+    // Each device gets resolved on its own, streaming its resources in as they are ready
     for (uint i = 0; devices && i < devices->len; i++) {
         FwupdDevice *device = (FwupdDevice *)g_ptr_array_index(devices, i);
 
         if (!fwupd_device_has_flag(device, FWUPD_DEVICE_FLAG_SUPPORTED))
             continue;
 
-        g_autoptr(GError) error = nullptr;
-        g_autoptr(GPtrArray) releases = fwupd_client_get_releases(client, fwupd_device_get_id(device), m_cancellable, &error);
+        ++m_pendingDevices;
+        auto request = new FwupdDeviceRequest{this, FWUPD_DEVICE(g_object_ref(device))};
+        fwupd_client_get_releases_async(client, fwupd_device_get_id(device), m_cancellable, fwupd_client_get_releases_cb, request);
+    }
+    if (devices) {
+        g_ptr_array_unref(devices);
+    }
 
-        if (error) {
-            if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED)) {
-                qWarning() << "fwupd: Device not supported:" << fwupd_device_get_name(device) << error->message;
-                continue;
-            }
-            if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE)) {
-                continue;
-            }
+    if (m_pendingDevices == 0) {
+        m_fetching = false;
+        Q_EMIT contentsChanged();
+        Q_EMIT initialized();
+    }
+}
 
-            handleError(error);
+void FwupdBackend::setReleases(FwupdDevice *device, GPtrArray *releases, GError *error)
+{
+    if (error) {
+        if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED)) {
+            qWarning() << "fwupd: Device not supported:" << fwupd_device_get_name(device) << error->message;
+            return;
         }
-
-        auto res = new FwupdResource(device, this);
-        for (uint i = 0; releases && i < releases->len; ++i) {
-            FwupdRelease *release = (FwupdRelease *)g_ptr_array_index(releases, i);
-            if (res->installedVersion().toUtf8() == fwupd_release_get_version(release)) {
-                res->setReleaseDetails(release);
-                break;
-            }
+        if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE)) {
+            return;
         }
-        addResource(res);
+
+        handleError(error);
     }
-    g_ptr_array_unref(devices);
 
-    addUpdates();
+    auto res = new FwupdResource(device, this);
+    for (uint i = 0; releases && i < releases->len; ++i) {
+        FwupdRelease *release = (FwupdRelease *)g_ptr_array_index(releases, i);
+        if (res->installedVersion().toUtf8() == fwupd_release_get_version(release)) {
+            res->setReleaseDetails(release);
+            break;
+        }
+    }
+    addResource(res);
+}
 
-    m_fetching = false;
+void FwupdBackend::deviceResolved()
+{
+    Q_ASSERT(m_pendingDevices > 0);
+    --m_pendingDevices;
     Q_EMIT contentsChanged();
-    Q_EMIT initialized();
+
+    if (m_pendingDevices == 0) {
+        m_fetching = false;
+        Q_EMIT initialized();
+    }
 }
 
 static void fwupd_client_get_remotes_cb(GObject * /*source*/, GAsyncResult *res, gpointer user_data)
@@ -70,6 +70,13 @@ public:
     static QString cacheFile(const QString &kind, const QString &baseName);
     void setDevices(GPtrArray *);
     void setRemotes(GPtrArray *);
+    void setReleases(FwupdDevice *device, GPtrArray *releases, GError *error);
+    void setUpgrades(FwupdDevice *device, GPtrArray *upgrades, GError *error);
+    void deviceResolved();
+    GCancellable *cancellable() const
+    {
+        return m_cancellable;
+    }
 
     int fetchingUpdatesProgress() const override
     {
@@ -85,7 +92,6 @@ Q_SIGNALS:
 
 private:
     ResultsStream *resourceForFile(const QUrl &);
-    void addUpdates();
     void addResource(FwupdResource *res);
 
     static QMap<GChecksumType, QCryptographicHash::Algorithm> gchecksumToQChryptographicHash();
@@ -97,6 +103,7 @@ private:
     QHash<QString, FwupdResource *> m_resources;
     StandardBackendUpdater *m_updater;
     bool m_fetching = false;
+    int m_pendingDevices = 0;
     int m_startElements;
     QList<AbstractResource *> m_toUpdate;
     GCancellable *m_cancellable;
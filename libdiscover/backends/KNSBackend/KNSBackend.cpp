@@ -5,6 +5,7 @@
  */
 
 // Qt includes
+#include <QDeadlineTimer>
 #include <QDebug>
 #include <QDir>
 #include <QDirIterator>
@@ -12,6 +13,8 @@
 #include <QStandardPaths>
 #include <QTimer>
 
+#include <utility>
+
 // KDE includes
 #include <KConfig>
 #include <KConfigGroup>
@@ -116,6 +119,40 @@ public:
         job->fetch();
     }
 
+    // Searches are remembered by the backend and always keep the following
+    // page loaded ahead, so that it's there as soon as the view asks for it.
+    // @p firstPage pages are already known, they are served from the cache.
+    void setCachedRequest(const QString &searchText, int firstPage, bool prefetchFirstPage)
+    {
+        Q_ASSERT(!m_started);
+        m_started = true;
+        m_searchText = searchText;
+        m_page = firstPage;
+        m_pendingProviders = providersCount();
+        m_awaitingPage = !prefetchFirstPage;
+        m_job = m_backend->engine()->search(
+            KNSCore::SearchRequest(KNSCore::SortMode::Newest, KNSCore::Filter::None, searchText, {}, firstPage, ENGINE_PAGE_SIZE));
+        connect(m_job, &KNSCore::ResultsStream::entriesFound, this, &KNSResultsStream::pageFound);
+        connect(m_job, &KNSCore::ResultsStream::finished, this, &KNSResultsStream::searchFinished);
+        connect(this, &ResultsStream::fetchMore, this, &KNSResultsStream::requestPage);
+        m_job->fetch();
+    }
+
+    void addCachedEntries(const QStringList &uniqueIds)
+    {
+        QList<StreamResult> res;
+        for (const QString &uniqueId : uniqueIds) {
+            auto resource = m_backend->m_resourcesByName.value(uniqueId);
+            if (resource && !m_sent.contains(uniqueId)) {
+                m_sent.insert(uniqueId);
+                res += StreamResult{resource, 0};
+            }
+        }
+        if (!res.isEmpty()) {
+            Q_EMIT resourcesFound(res);
+        }
+    }
+
     void addEntries(const KNSCore::Entry::List &entries)
     {
         // Should probably address that KNSCore::ResultsStream would return the Entry several times...
@@ -137,9 +174,77 @@ public:
     }
 
 private:
+    int providersCount() const
+    {
+        return std::max<int>(1, m_backend->engine()->providerIDs().size());
+    }
+
+    void pageFound(const KNSCore::Entry::List &entries)
+    {
+        // Every provider reports its part of the page we asked for last, the page
+        // is only complete once all of them did
+        m_pageEntries += entries;
+        if (m_awaitingPage) {
+            addEntries(entries);
+        } else {
+            m_prefetched += entries;
+        }
+        if (--m_pendingProviders > 0) {
+            return;
+        }
+
+        m_backend->cacheSearchPage(m_searchText, m_page, m_pageEntries);
+        if (m_awaitingPage) {
+            m_awaitingPage = false;
+            fetchNextPage();
+        } else {
+            m_pageComplete = true;
+        }
+    }
+
+    void requestPage()
+    {
+        if (!m_prefetched.isEmpty()) {
+            addEntries(std::exchange(m_prefetched, {}));
+        }
+        if (!m_pageComplete) {
+            // Still on its way, show the rest once it arrives
+            m_awaitingPage = true;
+            return;
+        }
+        fetchNextPage();
+    }
+
+    void fetchNextPage()
+    {
+        ++m_page;
+        m_pageEntries.clear();
+        m_pageComplete = false;
+        m_pendingProviders = providersCount();
+        m_job->fetchMore();
+    }
+
+    void searchFinished()
+    {
+        if (!m_prefetched.isEmpty()) {
+            addEntries(std::exchange(m_prefetched, {}));
+        }
+        m_backend->completeSearch(m_searchText);
+        finish();
+    }
+
     QSet<QString> m_sent;
     KNSBackend *const m_backend;
     bool m_started = false;
+
+    QString m_searchText;
+    KNSCore::ResultsStream *m_job = nullptr;
+    KNSCore::Entry::List m_prefetched;
+    KNSCore::Entry::List m_pageEntries;
+    int m_page = 0;
+    int m_pendingProviders = 0;
+    bool m_pageComplete = false;
+    bool m_awaitingPage = false;
 };
 
 KNSBackend::KNSBackend(QObject *parent, const QString &iconName, const QString &knsrc)
@@ -553,13 +658,52 @@ KNSResultsStream *KNSBackend::searchStream(const QString &searchText)
             stream->finish();
             return;
         }
-        KNSCore::SearchRequest p(KNSCore::SortMode::Newest, KNSCore::Filter::None, searchText, {}, 0, ENGINE_PAGE_SIZE);
-        stream->setRequest(p);
+
+        // Revisiting a category or a search shows what we got last time
+        const CachedSearch *cached = m_searchCache.object(searchText);
+        if (cached && !cached->expiry.hasExpired()) {
+            stream->addCachedEntries(cached->uniqueIds);
+            if (cached->complete) {
+                stream->finish();
+            } else {
+                stream->setCachedRequest(searchText, cached->pages, true);
+            }
+            return;
+        }
+
+        m_searchCache.insert(searchText, new CachedSearch{{}, {}, 0, false, QDeadlineTimer(s_searchCacheMaxAge)});
+        stream->setCachedRequest(searchText, 0, false);
     };
     deferredResultStream(stream, start);
     return stream;
 }
 
+void KNSBackend::cacheSearchPage(const QString &searchText, int page, const KNSCore::Entry::List &entries)
+{
+    CachedSearch *cached = m_searchCache.object(searchText);
+    if (!cached) {
+        return;
+    }
+    for (const KNSCore::Entry &entry : entries) {
+        if (!cached->knownIds.contains(entry.uniqueId())) {
+            cached->knownIds.insert(entry.uniqueId());
+            cached->uniqueIds += entry.uniqueId();
+        }
+    }
+    // Several streams may be paging through the same search, only count the pages
+    // that follow the ones we already have
+    if (page <= cached->pages) {
+        cached->pages = std::max(cached->pages, page + 1);
+    }
+}
+
+void KNSBackend::completeSearch(const QString &searchText)
+{
+    if (CachedSearch *cached = m_searchCache.object(searchText)) {
+        cached->complete = true;
+    }
+}
+
 ResultsStream *KNSBackend::findResourceByPackageName(const QUrl &search)
 {
     if (search.scheme() != QLatin1String("kns") || search.host() != name())
@@ -10,6 +10,10 @@
 #include <KNSCore/Entry>
 #include <KNSCore/ErrorCode>
 
+#include <QCache>
+#include <QDeadlineTimer>
+#include <QSet>
+
 #include "Transaction/AddonList.h"
 #include "discovercommon_export.h"
 #include <resources/AbstractResourcesBackend.h>
@@ -93,6 +97,22 @@ private:
     template<typename T>
     void deferredResultStream(KNSResultsStream *stream, T start);
     KNSResultsStream *searchStream(const QString &searchText);
+    void cacheSearchPage(const QString &searchText, int page, const KNSCore::Entry::List &entries);
+    void completeSearch(const QString &searchText);
+    friend class KNSResultsStream;
+
+    // Entries found for the most recent searches, by search text
+    struct CachedSearch {
+        // In the order they were found
+        QStringList uniqueIds;
+        QSet<QString> knownIds;
+        // Amount of consecutive pages, from the first one, in uniqueIds
+        int pages;
+        bool complete;
+        QDeadlineTimer expiry;
+    };
+    static constexpr std::chrono::minutes s_searchCacheMaxAge{15};
+    QCache<QString, CachedSearch> m_searchCache{20};
 
     bool m_fetching;
     bool m_isValid;
@@ -47,8 +47,29 @@ bool PKTransaction::isLocal() const
     return m_apps.size() == 1 && qobject_cast<LocalFilePKResource *>(m_apps.at(0));
 }
 
+QStringList PKTransaction::requestedPackageIds() const
+{
+    if (role() == Transaction::RemoveRole) {
+        return packageIds(m_apps, [](PackageKitResource *resource) {
+            return resource->installedPackageId();
+        });
+    }
+    return packageIds(m_apps, [](PackageKitResource *resource) {
+        return resource->availablePackageId();
+    });
+}
+
 void PKTransaction::start()
 {
+    // Local files aren't identified by their content, always simulate those
+    const auto backend = qobject_cast<PackageKitBackend *>(resource()->backend());
+    m_simulationKey = isLocal() ? QString() : backend->simulationKey(role(), requestedPackageIds());
+    if (const auto simulation = backend->cachedSimulation(m_simulationKey)) {
+        m_newPackageStates = *simulation;
+        simulated();
+        return;
+    }
+
     trigger(PackageKit::Transaction::TransactionFlagSimulate);
 }
 
@@ -66,9 +87,7 @@ void PKTransaction::trigger(PackageKit::Transaction::TransactionFlags flags)
         switch (role()) {
         case Transaction::ChangeAddonsRole:
         case Transaction::InstallRole: {
-            const auto ids = packageIds(m_apps, [](PackageKitResource *resource) {
-                return resource->availablePackageId();
-            });
+            const auto ids = requestedPackageIds();
             if (ids.isEmpty()) {
                 // FIXME this state shouldn't exist
                 qWarning() << "Installing no packages found!";
@@ -89,13 +108,7 @@ void PKTransaction::trigger(PackageKit::Transaction::TransactionFlags flags)
 #else
             constexpr bool autoRemove = false;
 #endif
-            m_trans = PackageKit::Daemon::removePackages(packageIds(m_apps,
-                                                                    [](PackageKitResource *resource) {
-                                                                        return resource->installedPackageId();
-                                                                    }),
-                                                         true /*allowDeps*/,
-                                                         autoRemove,
-                                                         flags);
+            m_trans = PackageKit::Daemon::removePackages(requestedPackageIds(), true /*allowDeps*/, autoRemove, flags);
             break;
         };
     Q_ASSERT(m_trans);
@@ -172,53 +185,10 @@ void PKTransaction::cleanup(PackageKit::Transaction::Exit exit, uint runtime)
     disconnect(m_trans, nullptr, this, nullptr);
     m_trans = nullptr;
 
-    const auto backend = qobject_cast<PackageKitBackend *>(resource()->backend());
-
     if (!cancel && !failed && simulate) {
-        auto packagesToRemove = m_newPackageStates.value(PackageKit::Transaction::InfoRemoving);
-        QMutableListIterator<QString> i(packagesToRemove);
-        QSet<AbstractResource *> removedResources;
-        while (i.hasNext()) {
-            const auto pkgname = PackageKit::Daemon::packageName(i.next());
-            removedResources.unite(backend->resourcesByPackageName(pkgname));
-
-            if (m_pkgnames.contains(pkgname)) {
-                i.remove();
-            }
-        }
-        removedResources.subtract(kToSet(m_apps));
-
-        auto isCritical = [](AbstractResource *resource) {
-            return static_cast<PackageKitResource *>(resource)->isCritical();
-        };
-        auto criticals = kFilter<QSet<AbstractResource *>>(removedResources, isCritical);
-        criticals.unite(kFilter<QSet<AbstractResource *>>(m_apps, isCritical));
-        auto resourceName = [](AbstractResource *a) {
-            return a->name();
-        };
-        if (!criticals.isEmpty()) {
-            const QString msg = i18n(
-                "This action cannot be completed as it would remove the following software which is critical to the system's operation:<nl/>"
-                "<ul><li>%1</li></ul><nl/>"
-                "If you believe this is an error, please report it as a bug to the packagers of your distribution.",
-                resourceName(*criticals.begin()));
-            Q_EMIT distroErrorMessage(msg);
-            setStatus(Transaction::DoneWithErrorStatus);
-        } else if (!packagesToRemove.isEmpty() || !removedResources.isEmpty()) {
-            QString msg;
-            const QStringList removedResourcesStr = kTransform<QStringList>(removedResources, resourceName);
-            msg += QLatin1String("<ul><li>") + PackageKitResource::joinPackages(packagesToRemove, QLatin1String("</li><li>"), {}) + QLatin1Char('\n');
-            msg += removedResourcesStr.join(QLatin1String("</li><li>"));
-            msg += QStringLiteral("</li></ul>");
-
-            Q_EMIT proceedRequest(i18n("Confirm package removal"),
-                                  i18np("This action will also remove the following package:\n%2",
-                                        "This action will also remove the following packages:\n%2",
-                                        packagesToRemove.count(),
-                                        msg));
-        } else {
-            proceed();
-        }
+        const auto backend = qobject_cast<PackageKitBackend *>(resource()->backend());
+        backend->cacheSimulation(m_simulationKey, m_newPackageStates);
+        simulated();
         return;
     }
 
@@ -235,6 +205,57 @@ void PKTransaction::cleanup(PackageKit::Transaction::Exit exit, uint runtime)
     }
 }
 
+void PKTransaction::simulated()
+{
+    const auto backend = qobject_cast<PackageKitBackend *>(resource()->backend());
+    auto packagesToRemove = m_newPackageStates.value(PackageKit::Transaction::InfoRemoving);
+    QStringList removedNames;
+    removedNames.reserve(packagesToRemove.size());
+    QMutableListIterator<QString> i(packagesToRemove);
+    while (i.hasNext()) {
+        const auto pkgname = PackageKit::Daemon::packageName(i.next());
+        removedNames += pkgname;
+
+        if (m_pkgnames.contains(pkgname)) {
+            i.remove();
+        }
+    }
+    auto removedResources = backend->resourcesByPackageNames<QSet<AbstractResource *>>(removedNames);
+    removedResources.subtract(kToSet(m_apps));
+
+    auto isCritical = [](AbstractResource *resource) {
+        return static_cast<PackageKitResource *>(resource)->isCritical();
+    };
+    auto criticals = kFilter<QSet<AbstractResource *>>(removedResources, isCritical);
+    criticals.unite(kFilter<QSet<AbstractResource *>>(m_apps, isCritical));
+    auto resourceName = [](AbstractResource *a) {
+        return a->name();
+    };
+    if (!criticals.isEmpty()) {
+        const QString msg = i18n(
+            "This action cannot be completed as it would remove the following software which is critical to the system's operation:<nl/>"
+            "<ul><li>%1</li></ul><nl/>"
+            "If you believe this is an error, please report it as a bug to the packagers of your distribution.",
+            resourceName(*criticals.begin()));
+        Q_EMIT distroErrorMessage(msg);
+        setStatus(Transaction::DoneWithErrorStatus);
+    } else if (!packagesToRemove.isEmpty() || !removedResources.isEmpty()) {
+        QString msg;
+        const QStringList removedResourcesStr = kTransform<QStringList>(removedResources, resourceName);
+        msg += QLatin1String("<ul><li>") + PackageKitResource::joinPackages(packagesToRemove, QLatin1String("</li><li>"), {}) + QLatin1Char('\n');
+        msg += removedResourcesStr.join(QLatin1String("</li><li>"));
+        msg += QStringLiteral("</li></ul>");
+
+        Q_EMIT proceedRequest(i18n("Confirm package removal"),
+                              i18np("This action will also remove the following package:\n%2",
+                                    "This action will also remove the following packages:\n%2",
+                                    packagesToRemove.count(),
+                                    msg));
+    } else {
+        proceed();
+    }
+}
+
 void PKTransaction::processProceedFunction()
 {
     auto t = m_proceedFunctions.takeFirst()();
@@ -274,19 +295,22 @@ void PKTransaction::packageResolved(PackageKit::Transaction::Info info, const QS
 void PKTransaction::submitResolve()
 {
     const auto backend = qobject_cast<PackageKitBackend *>(resource()->backend());
-    QStringList needResolving;
-    for (auto it = m_newPackageStates.constBegin(), itEnd = m_newPackageStates.constEnd(); it != itEnd; ++it) {
-        const auto &itValue = it.value();
-        for (const auto &pkgid : itValue) {
-            const auto resources = backend->resourcesByPackageName(PackageKit::Daemon::packageName(pkgid));
-            for (auto resource : resources) {
-                auto pkResource = qobject_cast<PackageKitResource *>(resource);
-                pkResource->clearPackageIds();
-                Q_EMIT pkResource->stateChanged();
-                needResolving << pkResource->allPackageNames();
-            }
+    QStringList pkgnames;
+    for (const auto &pkgids : std::as_const(m_newPackageStates)) {
+        for (const auto &pkgid : pkgids) {
+            pkgnames += PackageKit::Daemon::packageName(pkgid);
         }
     }
+    pkgnames.removeDuplicates();
+
+    QStringList needResolving;
+    const auto resources = backend->resourcesByPackageNames<QSet<AbstractResource *>>(pkgnames);
+    for (auto resource : resources) {
+        auto pkResource = qobject_cast<PackageKitResource *>(resource);
+        pkResource->clearPackageIds();
+        Q_EMIT pkResource->stateChanged();
+        needResolving << pkResource->allPackageNames();
+    }
     needResolving.removeDuplicates();
     backend->resolvePackages(needResolving);
 }
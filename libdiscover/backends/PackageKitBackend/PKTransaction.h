@@ -37,6 +37,8 @@ private:
     void cancellableChanged();
     void packageResolved(PackageKit::Transaction::Info info, const QString &packageId);
     void submitResolve();
+    void simulated();
+    QStringList requestedPackageIds() const;
     void repoSignatureRequired(const QString &packageID,
                                const QString &repoName,
                                const QString &keyUrl,
@@ -51,6 +53,7 @@ private:
     QPointer<PackageKit::Transaction> m_trans;
     const QVector<AbstractResource *> m_apps;
     QSet<QString> m_pkgnames;
+    QString m_simulationKey;
     QVector<std::function<PackageKit::Transaction *()>> m_proceedFunctions;
 
     QMap<PackageKit::Transaction::Info, QStringList> m_newPackageStates;
@@ -27,8 +27,10 @@
 #include <resources/SourcesModel.h>
 #include <resources/StandardBackendUpdater.h>
 
+#include <QCryptographicHash>
 #include <QDebug>
 #include <QDesktopServices>
+#include <QFileInfo>
 #include <QFileSystemWatcher>
 #include <QFutureWatcher>
 #include <QHash>
@@ -276,6 +278,13 @@ PackageKitBackend::PackageKitBackend(QObject *parent)
         m_updater->setNeedsReboot(true);
     });
     connect(PackageKit::Daemon::global(), &PackageKit::Daemon::isRunningChanged, this, &PackageKitBackend::checkDaemonRunning);
+    // Simulations depend on what the repositories offer
+    const auto invalidateSimulations = [this] {
+        ++m_simulationGeneration;
+        m_simulations.clear();
+    };
+    connect(PackageKit::Daemon::global(), &PackageKit::Daemon::repoListChanged, this, invalidateSimulations);
+    connect(PackageKit::Daemon::global(), &PackageKit::Daemon::updatesChanged, this, invalidateSimulations);
     connect(m_reviews.data(), &OdrsReviewsBackend::ratingsReady, this, [this] {
         const auto resources = m_packages.packages.values();
         m_reviews->emitRatingFetched(this, resources);
@@ -299,7 +308,7 @@ PackageKitBackend::PackageKitBackend(QObject *parent)
         [this](uint timeSince) {
             if (timeSince > 3600) {
                 checkForUpdates();
-            } else if (!PackageKit::Daemon::global()->offline()->upgradeTriggered()) {
+            } else if (!PackageKit::Daemon::global()->offline()->upgradeTriggered() && !loadUpdatesFromSnapshot(timeSince)) {
                 fetchUpdates();
             }
             acquireFetching(false);
@@ -558,11 +567,46 @@ void PackageKitBackend::fetchUpdates()
     connect(tUpdates, &PackageKit::Transaction::finished, this, &PackageKitBackend::getUpdatesFinished);
     connect(tUpdates, &PackageKit::Transaction::package, this, &PackageKitBackend::addPackageToUpdate);
     connect(tUpdates, &PackageKit::Transaction::errorCode, this, &PackageKitBackend::transactionError);
+    connect(tUpdates, &PackageKit::Transaction::package, this, [this](PackageKit::Transaction::Info info, const QString &packageId, const QString &summary) {
+        if (info != PackageKit::Transaction::InfoBlocked && info != PackageKit::Transaction::InfoRemoving && info != PackageKit::Transaction::InfoObsoleting) {
+            m_updatesSnapshot.updates.append({.id = packageId, .summary = summary, .security = info == PackageKit::Transaction::InfoSecurity, .kind = info});
+        }
+    });
+    connect(tUpdates, &PackageKit::Transaction::finished, this, [this](PackageKit::Transaction::Exit exit) {
+        if (exit == PackageKit::Transaction::ExitSuccess) {
+            m_updatesSnapshot.checked = QDateTime::currentDateTimeUtc();
+            m_updatesSnapshot.summarize();
+            UpdatesSnapshot::store(name(), m_updatesSnapshot);
+        }
+    });
     m_updatesPackageId.clear();
+    m_updatesSnapshot = {};
     m_hasSecurityUpdates = false;
     setRefresher(tUpdates);
 }
 
+bool PackageKitBackend::loadUpdatesFromSnapshot(uint timeSinceRefresh)
+{
+    // Only trust what was found after the last time the cache was refreshed
+    const auto snapshot = UpdatesSnapshot::load().backend(name());
+    if (!snapshot.isFresh() || snapshot.checked.secsTo(QDateTime::currentDateTimeUtc()) > timeSinceRefresh) {
+        return false;
+    }
+
+    qCDebug(LIBDISCOVER_BACKEND_PACKAGEKIT_LOG) << "Using the updates found at" << snapshot.checked << snapshot.count;
+    m_updatesPackageId.clear();
+    m_hasSecurityUpdates = false;
+    for (const auto &update : snapshot.updates) {
+        // Replayed as they were reported so they get filtered like a live getUpdates
+        const auto info = update.kind != PackageKit::Transaction::InfoUnknown
+            ? PackageKit::Transaction::Info(update.kind)
+            : (update.security ? PackageKit::Transaction::InfoSecurity : PackageKit::Transaction::InfoNormal);
+        addPackageToUpdate(info, update.id, update.summary);
+    }
+    getUpdatesFinished(PackageKit::Transaction::ExitSuccess, 0);
+    return true;
+}
+
 void PackageKitBackend::addPackageArch(PackageKit::Transaction::Info info, const QString &packageId, const QString &summary)
 {
     addPackage(info, packageId, summary, true);
@@ -695,6 +739,57 @@ T PackageKitBackend::resourcesByPackageNames(const W &pkgnames) const
     return ret;
 }
 
+// The package databases PackageKit usually sits on top of get touched whenever
+// packages are installed or removed, also by other tools than Discover.
+static qint64 packageDatabaseStamp()
+{
+    static const QStringList databases = {
+        u"/usr/lib/sysimage/rpm/rpmdb.sqlite"_s,
+        u"/var/lib/rpm/rpmdb.sqlite"_s,
+        u"/var/lib/dpkg/status"_s,
+        u"/var/lib/pacman/local"_s,
+    };
+    qint64 stamp = 0;
+    for (const QString &database : databases) {
+        const QFileInfo info(database);
+        if (info.exists()) {
+            stamp = std::max(stamp, info.lastModified().toMSecsSinceEpoch());
+        }
+    }
+    return stamp;
+}
+
+QString PackageKitBackend::simulationKey(::Transaction::Role role, const QStringList &packageIds) const
+{
+    if (packageIds.isEmpty()) {
+        return {};
+    }
+
+    QStringList sortedIds = packageIds;
+    sortedIds.sort();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(sortedIds.join(u'\n').toUtf8());
+    return u"%1-%2-%3-%4"_s.arg(int(role)).arg(m_simulationGeneration).arg(packageDatabaseStamp()).arg(QString::fromLatin1(hash.result().toHex()));
+}
+
+std::optional<PackageKitBackend::SimulationResult> PackageKitBackend::cachedSimulation(const QString &key) const
+{
+    const CachedSimulation *cached = key.isEmpty() ? nullptr : m_simulations.object(key);
+    if (!cached || cached->expiry.hasExpired()) {
+        return std::nullopt;
+    }
+    return cached->result;
+}
+
+void PackageKitBackend::cacheSimulation(const QString &key, const SimulationResult &result)
+{
+    if (key.isEmpty()) {
+        return;
+    }
+    // The database stamp doesn't catch everything, e.g. packages that got obsoleted server-side
+    m_simulations.insert(key, new CachedSimulation{result, QDeadlineTimer(std::chrono::minutes(10))});
+}
+
 void PackageKitBackend::checkForUpdates()
 {
     if (auto offline = PackageKit::Daemon::global()->offline(); offline->updateTriggered() || offline->upgradeTriggered()) {
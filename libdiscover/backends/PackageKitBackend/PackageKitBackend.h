@@ -10,6 +10,8 @@
 
 #include <PackageKit/Offline>
 #include <PackageKit/Transaction>
+#include <QCache>
+#include <QDeadlineTimer>
 #include <QHash>
 #include <QPointer>
 #include <QQueue>
@@ -19,10 +21,14 @@
 #include <QThreadPool>
 #include <QTimer>
 #include <QVariantList>
+#include <optional>
 
 #include <appstream/AppStreamConcurrentPool.h>
+#include <Transaction/Transaction.h>
 #include <resources/AbstractResourcesBackend.h>
 
+#include <UpdatesSnapshot.h>
+
 class AppPackageKitResource;
 class PackageKitUpdater;
 class PackageKitSourcesBackend;
@@ -102,6 +108,13 @@ public:
     QVector<AbstractResource *> extendedBy(const QString &id) const;
 
     PKResolveTransaction *resolvePackages(const QStringList &packageNames);
+
+    /// Packages a simulated transaction reported, by the state they would end up in
+    using SimulationResult = QMap<PackageKit::Transaction::Info, QStringList>;
+    /// Identifies a simulation of @p role on @p packageIds against the current repositories and installed packages
+    QString simulationKey(::Transaction::Role role, const QStringList &packageIds) const;
+    std::optional<SimulationResult> cachedSimulation(const QString &key) const;
+    void cacheSimulation(const QString &key, const SimulationResult &result);
     void fetchDetails(const QString &pkgid);
     void fetchDetails(const QSet<QString> &pkgid);
 
@@ -201,6 +214,7 @@ private:
     void updateProxy();
     void foundNewMajorVersion(const AppStream::Release &release);
     void setRefresher(PackageKit::Transaction *refresh);
+    bool loadUpdatesFromSnapshot(uint timeSinceRefresh);
     void processNextCoprInstalledStateCheck();
 
     QScopedPointer<AppStream::ConcurrentPool> m_appdata;
@@ -210,6 +224,7 @@ private:
     QPointer<PackageKit::Transaction> m_refresher;
     int m_isFetching;
     QSet<QString> m_updatesPackageId;
+    UpdatesSnapshot::Backend m_updatesSnapshot;
     bool m_hasSecurityUpdates = false;
     mutable QHash<PackageOrAppId, PackageKitResource *> m_packagesToAdd;
     QSet<PackageKitResource *> m_packagesToDelete;
@@ -225,6 +240,12 @@ private:
     QSharedPointer<OdrsReviewsBackend> m_reviews;
     QThreadPool m_threadPool;
     QPointer<PKResolveTransaction> m_resolveTransaction;
+    struct CachedSimulation {
+        SimulationResult result;
+        QDeadlineTimer expiry;
+    };
+    mutable QCache<QString, CachedSimulation> m_simulations{20};
+    quint64 m_simulationGeneration = 0;
     QStringList m_globalHints;
     bool m_allPackagesLoaded = false;
     CoprClient *m_coprClient = nullptr;
@@ -14,8 +14,6 @@
 #include <PackageKit/Daemon>
 #include <PackageKit/Transaction>
 
-#include <variant>
-
 using namespace Qt::StringLiterals;
 
 PackageKitDependency::PackageKitDependency(PackageKit::Transaction::Info info, const QString &packageId, const QString &summary)
@@ -57,16 +55,18 @@ QString PackageKitDependency::summary() const
     return m_summary;
 }
 
-PackageKitDependencies::PackageKitDependencies(QObject *parent)
-    : QObject(parent)
+namespace
 {
+constexpr int s_maxCachedPackages = 256;
 }
 
-PackageKitDependencies::~PackageKitDependencies()
+PackageKitDependencies::PackageKitDependencies(QObject *parent)
+    : QObject(parent)
 {
-    cancel(false);
 }
 
+PackageKitDependencies::~PackageKitDependencies() = default;
+
 QString PackageKitDependencies::packageId() const
 {
     return m_packageId;
@@ -75,85 +75,136 @@ QString PackageKitDependencies::packageId() const
 void PackageKitDependencies::setPackageId(const QString &packageId)
 {
     if (m_packageId != packageId) {
+        disconnect(m_pending);
         m_packageId = packageId;
-        cancel(true);
+        m_failed = false;
         Q_EMIT packageIdChanged();
+        Q_EMIT dependenciesChanged();
     }
 }
 
 bool PackageKitDependencies::hasFetchedDependencies()
 {
-    return m_state.has_value() && std::holds_alternative<Data>(*m_state);
+    return m_packageId.isEmpty() || m_failed || PackageKitDependencyService::global()->cached(m_packageId).has_value();
 }
 
 QList<PackageKitDependency> PackageKitDependencies::dependencies()
 {
-    if (!m_state.has_value()) {
+    if (m_packageId.isEmpty()) {
         return {};
     }
-    if (auto list = std::get_if<Data>(&m_state.value())) {
-        return *list;
+    // Only the ones that were looked at need to know when the cache goes away
+    if (!m_cleared) {
+        m_cleared = connect(PackageKitDependencyService::global(), &PackageKitDependencyService::cleared, this, [this] {
+            m_failed = false;
+            if (!m_packageId.isEmpty()) {
+                Q_EMIT dependenciesChanged();
+            }
+        });
+    }
+    if (auto dependencies = PackageKitDependencyService::global()->cached(m_packageId)) {
+        return *dependencies;
+    }
+    if (!m_failed) {
+        start();
     }
-    // the job is still running
     return {};
 }
 
 void PackageKitDependencies::start()
 {
-    Q_ASSERT(!m_state.has_value()); // cancel must have been called before!
-    Job job{new PackageKitFetchDependenciesJob(m_packageId)};
-    connect(job, &PackageKitFetchDependenciesJob::finished, this, &PackageKitDependencies::onJobFinished);
-    m_state = job;
+    auto service = PackageKitDependencyService::global();
+    if (!m_pending) {
+        m_pending = connect(service, &PackageKitDependencyService::fetched, this, &PackageKitDependencies::onFetched);
+    }
+    service->fetch(m_packageId);
 }
 
 void PackageKitDependencies::refresh()
 {
-    cancel(true);
+    PackageKitDependencyService::global()->invalidate(m_packageId);
+    m_failed = false;
+    Q_EMIT dependenciesChanged();
     start();
 }
 
-void PackageKitDependencies::onJobFinished(const QList<PackageKitDependency> &dependencies)
+void PackageKitDependencies::onFetched(const QString &packageId, bool succeeded)
 {
-    Q_ASSERT(m_state.has_value());
-    Q_ASSERT(std::holds_alternative<Job>(m_state.value()));
+    if (packageId == m_packageId) {
+        disconnect(m_pending);
+        m_failed = !succeeded;
+        Q_EMIT dependenciesChanged();
+    }
+}
 
-    if (auto job = std::get<Job>(m_state.value())) {
-        // Should not emit twice, but better be on the safe side
-        disconnect(job, &PackageKitFetchDependenciesJob::finished, this, &PackageKitDependencies::onJobFinished);
+void PackageKitDependencies::setDirty()
+{
+    const bool hadDependencies = !m_packageId.isEmpty() && hasFetchedDependencies();
+    PackageKitDependencyService::global()->invalidate(m_packageId);
+    m_failed = false;
+    if (hadDependencies) {
+        Q_EMIT dependenciesChanged();
     }
+}
 
-    m_state = dependencies;
-    Q_EMIT dependenciesChanged();
+PackageKitDependencyService *PackageKitDependencyService::global()
+{
+    static PackageKitDependencyService service;
+    return &service;
 }
 
-void PackageKitDependencies::cancel(bool notify)
+PackageKitDependencyService::PackageKitDependencyService()
 {
-    if (m_state.has_value()) {
-        if (auto jobPtr = std::get_if<Job>(&m_state.value())) {
-            if (auto job = *jobPtr) {
-                disconnect(job, &PackageKitFetchDependenciesJob::finished, this, &PackageKitDependencies::onJobFinished);
-                job->cancel();
-            }
-            notify = false;
-        }
-        m_state.reset();
-        // first reset, only then notify and only if variant held Data before (i.e. not a Job)
-        if (notify) {
-            Q_EMIT dependenciesChanged();
-        }
+    m_cache.setMaxCost(s_maxCachedPackages);
+
+    connect(PackageKit::Daemon::global(), &PackageKit::Daemon::updatesChanged, this, &PackageKitDependencyService::clear);
+    connect(PackageKit::Daemon::global(), &PackageKit::Daemon::repoListChanged, this, &PackageKitDependencyService::clear);
+}
+
+std::optional<QList<PackageKitDependency>> PackageKitDependencyService::cached(const QString &packageId) const
+{
+    if (auto dependencies = m_cache.object(packageId)) {
+        return *dependencies;
     }
+    return std::nullopt;
 }
 
-PackageKitFetchDependenciesJob::PackageKitFetchDependenciesJob(const QString &packageId)
+void PackageKitDependencyService::fetch(const QString &packageId)
 {
-    if (packageId.isEmpty()) {
-        onTransactionFinished();
+    if (packageId.isEmpty() || m_jobs.value(packageId) || m_cache.contains(packageId)) {
         return;
     }
 
+    auto job = new PackageKitFetchDependenciesJob(packageId);
+    m_jobs.insert(packageId, job);
+    connect(job, &PackageKitFetchDependenciesJob::finished, this, [this, packageId](const QList<PackageKitDependency> &dependencies, bool succeeded) {
+        m_jobs.remove(packageId);
+        // A failed transaction says nothing about the dependencies, let them be asked again
+        if (succeeded) {
+            m_cache.insert(packageId, new QList<PackageKitDependency>(dependencies));
+        }
+        Q_EMIT fetched(packageId, succeeded);
+    });
+}
+
+void PackageKitDependencyService::invalidate(const QString &packageId)
+{
+    m_cache.remove(packageId);
+}
+
+void PackageKitDependencyService::clear()
+{
+    m_cache.clear();
+    Q_EMIT cleared();
+}
+
+PackageKitFetchDependenciesJob::PackageKitFetchDependenciesJob(const QString &packageId)
+{
     m_transaction = PackageKit::Daemon::dependsOn(packageId);
     if (!m_transaction) {
-        onTransactionFinished();
+        m_failed = true;
+        // Let the caller connect to finished() first
+        QMetaObject::invokeMethod(this, &PackageKitFetchDependenciesJob::onTransactionFinished, Qt::QueuedConnection);
         return;
     }
 
@@ -181,6 +232,7 @@ void PackageKitFetchDependenciesJob::cancel()
 void PackageKitFetchDependenciesJob::onTransactionErrorCode(PackageKit::Transaction::Error error, const QString &details)
 {
     qCWarning(LIBDISCOVER_BACKEND_PACKAGEKIT_LOG) << "PackageKitFetchDependenciesJob: Transaction error:" << m_transaction << error << details;
+    m_failed = true;
 }
 
 void PackageKitFetchDependenciesJob::onTransactionPackage(PackageKit::Transaction::Info info, const QString &packageId, const QString &summary)
@@ -194,14 +246,9 @@ void PackageKitFetchDependenciesJob::onTransactionFinished()
         return a.info() < b.info() || (a.info() == b.info() && a.packageName() < b.packageName());
     });
 
-    Q_EMIT finished(m_dependencies);
+    Q_EMIT finished(m_dependencies, !m_failed);
 
     deleteLater();
 }
 
-void PackageKitDependencies::setDirty()
-{
-    cancel(true);
-}
-
 #include "moc_PackageKitDependencies.cpp"
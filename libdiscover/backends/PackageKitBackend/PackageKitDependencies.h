@@ -8,10 +8,10 @@
 #pragma once
 
 #include <PackageKit/Transaction>
+#include <QCache>
 #include <QPointer>
 
 #include <optional>
-#include <variant>
 
 class PackageKitFetchDependenciesJob;
 
@@ -44,7 +44,8 @@ private:
     QString m_summary;
 };
 
-// Lazy job runner. Guards against starting two jobs at once. Resets itself when package ID changes.
+// Dependencies of a package. Fetches them lazily through PackageKitDependencyService
+// and notifies once they are available.
 class PackageKitDependencies : public QObject
 {
     Q_OBJECT
@@ -69,22 +70,49 @@ Q_SIGNALS:
     void packageIdChanged();
     void dependenciesChanged();
 
-private Q_SLOTS:
-    void onJobFinished(const QList<PackageKitDependency> &dependencies);
-
 private:
-    using Job = QPointer<PackageKitFetchDependenciesJob>;
-    using Data = QList<PackageKitDependency>;
-
     void start();
-    void cancel(bool notify);
+    void onFetched(const QString &packageId, bool succeeded);
 
     QString m_packageId;
-    // tri-state:
-    // - no work done or even started yet: nullopt;
-    // - job is currently running, no need to start another one: optional(Job);
-    // - data is available: optional(Data).
-    std::optional<std::variant<Job, Data>> m_state;
+    // Set when fetching failed, so reading the dependencies doesn't ask again right away
+    bool m_failed = false;
+    QMetaObject::Connection m_pending;
+    QMetaObject::Connection m_cleared;
+};
+
+// Shared by all the resources, so the dependencies don't need to be fetched again
+// when a page is opened again. Keeps the most recently used results.
+class PackageKitDependencyService : public QObject
+{
+    Q_OBJECT
+public:
+    static PackageKitDependencyService *global();
+
+    // Cached dependencies of @p packageId, nullopt if they need fetching
+    std::optional<QList<PackageKitDependency>> cached(const QString &packageId) const;
+
+    // Fetches the dependencies of @p packageId unless they're already cached
+    // or being fetched, emits fetched() once done.
+    void fetch(const QString &packageId);
+
+    // Drops the cached dependencies of @p packageId
+    void invalidate(const QString &packageId);
+    // Installing or removing anything may change what the dependencies resolve to,
+    // done whenever PackageKit reports the updates or the repositories changed
+    void clear();
+
+Q_SIGNALS:
+    // The dependencies are cached unless the transaction failed
+    void fetched(const QString &packageId, bool succeeded);
+    // Everything needs fetching again
+    void cleared();
+
+private:
+    PackageKitDependencyService();
+
+    QCache<QString, QList<PackageKitDependency>> m_cache;
+    QHash<QString, QPointer<PackageKitFetchDependenciesJob>> m_jobs;
 };
 
 // Wrapper which hides some complexity of PackageKit::Transaction management.
@@ -101,7 +129,7 @@ public:
     void cancel();
 
 Q_SIGNALS:
-    void finished(QList<PackageKitDependency> dependencies);
+    void finished(QList<PackageKitDependency> dependencies, bool succeeded);
 
 private Q_SLOTS:
     void onTransactionErrorCode(PackageKit::Transaction::Error error, const QString &details);
@@ -111,4 +139,5 @@ private Q_SLOTS:
 private:
     QPointer<PackageKit::Transaction> m_transaction;
     QList<PackageKitDependency> m_dependencies;
+    bool m_failed = false;
 };
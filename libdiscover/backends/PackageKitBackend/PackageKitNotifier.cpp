@@ -14,6 +14,7 @@
 #include <PackageKit/Daemon>
 #include <PackageKit/Offline>
 #include <QDBusInterface>
+#include <QDBusPendingCallWatcher>
 #include <QDebug>
 #include <QFile>
 #include <QFileSystemWatcher>
@@ -83,6 +84,19 @@ PackageKitNotifier::PackageKitNotifier(QObject *parent)
 
     QTimer::singleShot(3s, this, &PackageKitNotifier::checkOfflineUpdates);
 
+    // Start off with whatever was found last time, be it by us or by Discover
+    const auto snapshot = UpdatesSnapshot::load().backend(QStringLiteral("packagekit-backend"));
+    if (snapshot.isFresh()) {
+        m_cachedStateChecked = snapshot.checked;
+        for (const auto &update : snapshot.updates) {
+            if (update.security) {
+                m_securityUpdates++;
+            } else {
+                m_normalUpdates++;
+            }
+        }
+    }
+
     m_recheckTimer = new QTimer(this);
     m_recheckTimer->setInterval(200);
     m_recheckTimer->setSingleShot(true);
@@ -95,24 +109,23 @@ PackageKitNotifier::~PackageKitNotifier()
 
 void PackageKitNotifier::checkOfflineUpdates()
 {
-    auto offline = PackageKit::Daemon::global()->offline();
-
-    const bool isMobile = QByteArrayList{"1", "true"}.contains(qgetenv("QT_QUICK_CONTROLS_MOBILE"));
 #if QPK_CHECK_VERSION(1, 1, 4)
-    auto results = offline->getResults();
-    results.waitForFinished();
-    if (results.isError()) {
-        return;
-    }
+    // Don't block the notifier on the daemon, it may have to be activated first
+    auto results = PackageKit::Daemon::global()->offline()->getResults();
+    auto watcher = new QDBusPendingCallWatcher(results, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, watcher, results] {
+        watcher->deleteLater();
+        if (results.isError()) {
+            return;
+        }
 
-    const bool success = results.success();
-    const auto packages = results.packageIds();
-    const auto errorCode = results.error();
-    static QSet<PackageKit::Transaction::Error> allowedAlreadyInstalled = {
-        PackageKit::Transaction::ErrorPackageAlreadyInstalled,
-        PackageKit::Transaction::ErrorAllPackagesAlreadyInstalled,
-    };
-    const QString errorDetails = results.errorDescription();
+        static const QSet<PackageKit::Transaction::Error> allowedAlreadyInstalled = {
+            PackageKit::Transaction::ErrorPackageAlreadyInstalled,
+            PackageKit::Transaction::ErrorAllPackagesAlreadyInstalled,
+        };
+        const bool failed = !results.success() && !allowedAlreadyInstalled.contains(results.error());
+        showOfflineUpdateResults(failed, results.packageIds().count(), results.errorDescription());
+    });
 #else
     if (!QFile::exists(QStringLiteral(PK_OFFLINE_RESULTS_FILENAME))) {
         return;
@@ -128,13 +141,19 @@ void PackageKitNotifier::checkOfflineUpdates()
         QStringLiteral("package-already-installed"),
         QStringLiteral("all-packages-already-installed"),
     };
-    const QString errorDetails = group.readEntry("ErrorDetails");
+    const bool failed = !success && !allowedAlreadyInstalled.contains(errorCode);
+    showOfflineUpdateResults(failed, packages.count(), group.readEntry("ErrorDetails"));
 #endif
-    if (!success && !allowedAlreadyInstalled.contains(errorCode)) {
+}
+
+void PackageKitNotifier::showOfflineUpdateResults(bool failed, qsizetype packageCount, const QString &errorDetails)
+{
+    const bool isMobile = QByteArrayList{"1", "true"}.contains(qgetenv("QT_QUICK_CONTROLS_MOBILE"));
+    if (failed) {
         auto *notification = new KNotification(QStringLiteral("OfflineUpdateFailed"), KNotification::Persistent);
         notification->setIconName(QStringLiteral("dialog-error"));
         notification->setTitle(i18n("Failed Offline Update"));
-        notification->setText(i18np("Failed to update %1 package\n%2", "Failed to update %1 packages\n%2", packages.count(), errorDetails));
+        notification->setText(i18np("Failed to update %1 package\n%2", "Failed to update %1 packages\n%2", packageCount, errorDetails));
         notification->setComponentName(QStringLiteral("discoverabstractnotifier"));
 
         auto openDiscoverAction = notification->addAction(i18nc("@action:button", "Open Discover"));
@@ -185,7 +204,7 @@ void PackageKitNotifier::checkOfflineUpdates()
             KNotification *notification = new KNotification(QStringLiteral("OfflineUpdateSuccessful"));
             notification->setIconName(QStringLiteral("system-software-update"));
             notification->setTitle(i18n("Offline Updates"));
-            notification->setText(i18np("Successfully updated %1 package", "Successfully updated %1 packages", packages.count()));
+            notification->setText(i18np("Successfully updated %1 package", "Successfully updated %1 packages", packageCount));
             notification->setComponentName(QStringLiteral("discoverabstractnotifier"));
 
             auto openDiscoverAction = notification->addAction(i18nc("@action:button", "Open Discover"));
@@ -195,7 +214,7 @@ void PackageKitNotifier::checkOfflineUpdates()
 
             notification->sendEvent();
         }
-        offline->clearResults();
+        PackageKit::Daemon::global()->offline()->clearResults();
     }
 }
 
@@ -230,17 +249,21 @@ void PackageKitNotifier::setupGetUpdatesTransaction(PackageKit::Transaction *tra
 
     trans->setProperty("normalUpdates", 0);
     trans->setProperty("securityUpdates", 0);
+    m_pendingSnapshots.insert(trans, {});
+    connect(trans, &QObject::destroyed, this, [this, trans] {
+        m_pendingSnapshots.remove(trans);
+    });
     connect(trans, &PackageKit::Transaction::package, this, &PackageKitNotifier::package);
     connect(trans, &PackageKit::Transaction::finished, this, &PackageKitNotifier::finished);
 }
 
-void PackageKitNotifier::package(PackageKit::Transaction::Info info, const QString & /*packageID*/, const QString & /*summary*/)
+void PackageKitNotifier::package(PackageKit::Transaction::Info info, const QString &packageID, const QString &summary)
 {
     PackageKit::Transaction *trans = qobject_cast<PackageKit::Transaction *>(sender());
 
     switch (info) {
     case PackageKit::Transaction::InfoBlocked:
-        break; // skip, we ignore blocked updates
+        return; // skip, we ignore blocked updates
     case PackageKit::Transaction::InfoSecurity:
         trans->setProperty("securityUpdates", trans->property("securityUpdates").toInt() + 1);
         break;
@@ -248,11 +271,24 @@ void PackageKitNotifier::package(PackageKit::Transaction::Info info, const QStri
         trans->setProperty("normalUpdates", trans->property("normalUpdates").toInt() + 1);
         break;
     }
+    m_pendingSnapshots[trans].updates.append({
+        .id = packageID,
+        .summary = summary,
+        .security = info == PackageKit::Transaction::InfoSecurity,
+        .kind = info,
+    });
 }
 
-void PackageKitNotifier::finished(PackageKit::Transaction::Exit /*exit*/, uint)
+void PackageKitNotifier::finished(PackageKit::Transaction::Exit exit, uint)
 {
-    const PackageKit::Transaction *trans = qobject_cast<PackageKit::Transaction *>(sender());
+    PackageKit::Transaction *trans = qobject_cast<PackageKit::Transaction *>(sender());
+
+    auto snapshot = m_pendingSnapshots.take(trans);
+    if (exit == PackageKit::Transaction::ExitSuccess) {
+        snapshot.checked = QDateTime::currentDateTimeUtc();
+        snapshot.summarize();
+        UpdatesSnapshot::store(QStringLiteral("packagekit-backend"), snapshot);
+    }
 
     const uint normalUpdates = trans->property("normalUpdates").toInt();
     const uint securityUpdates = trans->property("securityUpdates").toInt();
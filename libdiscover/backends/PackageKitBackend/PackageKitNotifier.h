@@ -8,6 +8,7 @@
 #include <AppStreamQt/pool.h>
 #include <BackendNotifierModule.h>
 #include <PackageKit/Transaction>
+#include <UpdatesSnapshot.h>
 #include <QPointer>
 #include <QVariantList>
 #include <functional>
@@ -32,6 +33,10 @@ public:
     {
         return m_needsReboot;
     }
+    QDateTime cachedStateChecked() const override
+    {
+        return m_cachedStateChecked;
+    }
     void checkDistroUpgrade();
 
 private Q_SLOTS:
@@ -45,6 +50,7 @@ private:
     void nowNeedsReboot();
     void recheckSystemUpdate();
     void checkOfflineUpdates();
+    void showOfflineUpdateResults(bool failed, qsizetype packageCount, const QString &errorDetails);
     void setupGetUpdatesTransaction(PackageKit::Transaction *transaction);
     QProcess *checkAptVariable(const QString &aptconfig, const QLatin1String &varname, const std::function<void(const QStringView &val)> &func);
 
@@ -54,7 +60,10 @@ private:
     bool m_hasDistUpgrade;
     QPointer<PackageKit::Transaction> m_refresher;
     QTimer *m_recheckTimer;
+    QDateTime m_cachedStateChecked;
 
     QHash<QString, PackageKit::Transaction *> m_transactions;
+    // What each getUpdates transaction found so far
+    QHash<PackageKit::Transaction *, UpdatesSnapshot::Backend> m_pendingSnapshots;
     std::unique_ptr<AppStream::Pool> m_appdata;
 };
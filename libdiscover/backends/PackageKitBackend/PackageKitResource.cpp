@@ -299,6 +299,11 @@ void PackageKitResource::failedFetchingDetails(PackageKit::Transaction::Error er
 
 QList<PackageKitDependency> PackageKitResource::dependencies()
 {
+    {
+        // We're being read, there's no one to notify about the package we're looking at
+        const QSignalBlocker blocker(m_dependencies);
+        m_dependencies.setPackageId(availablePackageId());
+    }
     return m_dependencies.dependencies();
 }
 
@@ -14,6 +14,7 @@
 #include <QDebug>
 #include <QProcess>
 #include <QRegularExpression>
+#include <QSet>
 #include <QStandardItemModel>
 #include <resources/AbstractResourcesBackend.h>
 #include <resources/DiscoverAction.h>
@@ -79,6 +80,11 @@ PackageKitSourcesBackend::PackageKitSourcesBackend(AbstractResourcesBackend *par
     : AbstractSourcesBackend(parent)
     , m_sources(new PKSourcesModel(this))
 {
+    // Enabling a COPR or editing repository files makes PackageKit notify several times in a row
+    m_resetTimer.setSingleShot(true);
+    m_resetTimer.setInterval(200);
+    connect(&m_resetTimer, &QTimer::timeout, this, &PackageKitSourcesBackend::fetchSources);
+
     connect(PackageKit::Daemon::global(), &PackageKit::Daemon::repoListChanged, this, &PackageKitSourcesBackend::resetSources);
     connect(SourcesModel::global(), &SourcesModel::showingNow, this, &PackageKitSourcesBackend::resetSources);
 
@@ -107,40 +113,71 @@ QString PackageKitSourcesBackend::idDescription()
 
 QStandardItem *PackageKitSourcesBackend::findItemForId(const QString &id) const
 {
-    for (int i = 0, c = m_sources->rowCount(); i < c; ++i) {
-        auto it = m_sources->item(i);
-        if (it->data(AbstractSourcesBackend::IdRole).toString() == id) {
-            return it;
-        }
-    }
-    return nullptr;
+    return m_items.value(id);
+}
+
+void PackageKitSourcesBackend::updateItem(QStandardItem *item, const Repository &repository)
+{
+    // QStandardItem only notifies about actual changes
+    item->setText(repository.description);
+    item->setCheckState(repository.enabled ? Qt::Checked : Qt::Unchecked);
 }
 
-void PackageKitSourcesBackend::addRepositoryDetails(const QString &id, const QString &description, bool enabled)
+void PackageKitSourcesBackend::applyRepositories(const QList<Repository> &repositories)
 {
-    bool add = false;
-    QStandardItem *item = findItemForId(id);
+    QSet<QString> ids;
+    ids.reserve(repositories.size());
+    for (const Repository &repository : repositories) {
+        ids.insert(repository.id);
+    }
+
+    // Remove the repositories that are gone, a contiguous range at a time
+    for (int last = m_sources->rowCount() - 1; last >= 0;) {
+        int first = last;
+        while (first >= 0 && !ids.contains(m_sources->item(first)->data(IdRole).toString())) {
+            m_items.remove(m_sources->item(first)->data(IdRole).toString());
+            --first;
+        }
+        if (first < last) {
+            m_sources->removeRows(first + 1, last - first);
+        }
+        last = first - 1;
+    }
 
-    if (!item) {
-        item = new QStandardItem(description);
+    QList<QStandardItem *> added;
+    QSet<QString> addedIds;
+    for (const Repository &repository : repositories) {
+        if (auto item = findItemForId(repository.id)) {
+            updateItem(item, repository);
+            continue;
+        }
+        if (addedIds.contains(repository.id)) {
+            continue;
+        }
+        addedIds.insert(repository.id);
+
+        auto item = new QStandardItem(repository.description);
         if (PackageKit::Daemon::backendName() == QLatin1String("aptcc")) {
             QRegularExpression exp(QStringLiteral("^/etc/apt/sources.list.d/(.+?).list:.*"));
 
-            auto matchIt = exp.globalMatch(id);
+            auto matchIt = exp.globalMatch(repository.id);
             if (matchIt.hasNext()) {
                 auto match = matchIt.next();
                 item->setData(match.captured(1), Qt::ToolTipRole);
             }
         }
         item->setCheckable(PackageKit::Daemon::roles() & PackageKit::Transaction::RoleRepoEnable);
-        add = true;
+        item->setData(repository.id, IdRole);
+        updateItem(item, repository);
+        added += item;
     }
-    item->setData(id, IdRole);
-    item->setCheckState(enabled ? Qt::Checked : Qt::Unchecked);
-    item->setEnabled(true);
 
-    if (add) {
-        m_sources->appendRow(item);
+    if (!added.isEmpty()) {
+        // One insertion for all the new repositories rather than a relayout per row
+        for (QStandardItem *item : std::as_const(added)) {
+            m_items.insert(item->data(IdRole).toString(), item);
+        }
+        m_sources->invisibleRootItem()->insertRows(m_sources->rowCount(), added);
     }
 }
 
@@ -169,19 +206,33 @@ QVariantList PackageKitSourcesBackend::actions() const
 void PackageKitSourcesBackend::resetSources()
 {
     disconnect(SourcesModel::global(), &SourcesModel::showingNow, this, &PackageKitSourcesBackend::resetSources);
-    for (int i = 0, count = m_sources->rowCount(); i < count; ++i) {
-        m_sources->item(i, 0)->setEnabled(false);
+    if (m_repoListTransaction) {
+        // The list being fetched might predate the change, fetch it again once it's done
+        m_resetPending = true;
+        return;
     }
-    auto transaction = PackageKit::Daemon::global()->getRepoList();
-    connect(transaction, &PackageKit::Transaction::repoDetail, this, &PackageKitSourcesBackend::addRepositoryDetails);
-    connect(transaction, &PackageKit::Transaction::errorCode, this, &PackageKitSourcesBackend::transactionError);
-    connect(transaction, &PackageKit::Transaction::finished, this, [this] {
-        for (int i = 0; i < m_sources->rowCount();) {
-            if (!m_sources->item(i, 0)->isEnabled()) {
-                m_sources->removeRow(i);
-            } else {
-                ++i;
-            }
+    m_resetTimer.start();
+}
+
+void PackageKitSourcesBackend::fetchSources()
+{
+    m_fetchedRepositories.clear();
+    m_repoListTransaction = PackageKit::Daemon::global()->getRepoList();
+    connect(m_repoListTransaction, &PackageKit::Transaction::repoDetail, this, [this](const QString &id, const QString &description, bool enabled) {
+        m_fetchedRepositories.append(Repository{id, description, enabled});
+    });
+    connect(m_repoListTransaction, &PackageKit::Transaction::errorCode, this, &PackageKitSourcesBackend::transactionError);
+    connect(m_repoListTransaction, &PackageKit::Transaction::finished, this, [this](PackageKit::Transaction::Exit exit) {
+        // Keep showing what we had rather than emptying the list on failure
+        if (exit == PackageKit::Transaction::ExitSuccess) {
+            applyRepositories(m_fetchedRepositories);
+        }
+        m_fetchedRepositories.clear();
+        m_repoListTransaction.clear();
+
+        if (m_resetPending) {
+            m_resetPending = false;
+            m_resetTimer.start();
         }
     });
 }
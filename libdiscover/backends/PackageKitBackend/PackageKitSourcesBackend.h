@@ -7,6 +7,9 @@
 #pragma once
 
 #include <PackageKit/Transaction>
+#include <QHash>
+#include <QPointer>
+#include <QTimer>
 #include <resources/AbstractSourcesBackend.h>
 
 class QStandardItem;
@@ -31,12 +34,27 @@ public:
     QVariantList actions() const override;
 
     void transactionError(PackageKit::Transaction::Error, const QString &message);
+    // Schedules listing the repositories again, bursts of requests are coalesced
     void resetSources();
 
 private:
-    void addRepositoryDetails(const QString &id, const QString &description, bool enabled);
+    struct Repository {
+        QString id;
+        QString description;
+        bool enabled;
+    };
+
+    void fetchSources();
+    void applyRepositories(const QList<Repository> &repositories);
+    void updateItem(QStandardItem *item, const Repository &repository);
     QStandardItem *findItemForId(const QString &id) const;
 
     PKSourcesModel *m_sources;
     QVariantList m_actions;
+    // id -> item, kept in sync with m_sources
+    QHash<QString, QStandardItem *> m_items;
+    QList<Repository> m_fetchedRepositories;
+    QPointer<PackageKit::Transaction> m_repoListTransaction;
+    bool m_resetPending = false;
+    QTimer m_resetTimer;
 };
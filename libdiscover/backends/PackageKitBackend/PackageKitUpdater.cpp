@@ -13,6 +13,7 @@
 #include <QCryptographicHash>
 #include <QDBusConnection>
 #include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
 #include <QDBusReply>
 #include <QDebug>
 #include <QIcon>
@@ -347,15 +348,22 @@ void PackageKitUpdater::prepare()
     }
 
 #if QPK_CHECK_VERSION(1, 1, 4)
+    // Stale results only need clearing, nothing below depends on them so don't wait for the daemon
     auto results = offline->getResults();
-    results.waitForFinished();
-    if (results.isError() || !results.success()) {
+    auto resultsWatcher = new QDBusPendingCallWatcher(results, this);
+    connect(resultsWatcher, &QDBusPendingCallWatcher::finished, this, [resultsWatcher, results] {
+        resultsWatcher->deleteLater();
+        if (results.isError() || !results.success()) {
+            qCDebug(LIBDISCOVER_BACKEND_PACKAGEKIT_LOG) << "Removed offline results file";
+            PackageKit::Daemon::global()->offline()->clearResults();
+        }
+    });
 #else
     if (QFile::exists(QStringLiteral(PK_OFFLINE_RESULTS_FILENAME))) {
-#endif
         qCDebug(LIBDISCOVER_BACKEND_PACKAGEKIT_LOG) << "Removed offline results file";
         offline->clearResults();
     }
+#endif
 
     Q_ASSERT(!m_transaction);
     const auto candidates = m_backend->upgradeablePackages();
@@ -658,22 +666,26 @@ void PackageKitUpdater::finished(PackageKit::Transaction::Exit exit, uint /*time
 
     if (useOfflineUpdates() && exit == PackageKit::Transaction::ExitSuccess) {
         if (m_upgrade->isDistroUpgrade()) {
-            QDBusPendingReply<void> reply = PackageKit::Daemon::global()->offline()->triggerUpgrade(PackageKit::Offline::ActionReboot);
-            // Call may fail because of authorization
-            reply.waitForFinished();
-            if (reply.isError()) {
-                Q_EMIT resourceProgressed(m_upgrade, 0, None);
-                setNeedsReboot(false);
+            // Call may wait on or fail because of authorization, stay progressing until it's answered
+            auto watcher = new QDBusPendingCallWatcher(PackageKit::Daemon::global()->offline()->triggerUpgrade(PackageKit::Offline::ActionReboot), this);
+            connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, watcher] {
+                watcher->deleteLater();
+                QDBusPendingReply<void> reply = *watcher;
+                if (reply.isError()) {
+                    Q_EMIT resourceProgressed(m_upgrade, 0, None);
+                    setNeedsReboot(false);
+                    setProgressing(false);
+                    Q_EMIT passiveMessage(reply.error().message());
+                    return;
+                }
+                m_backend->clear();
                 setProgressing(false);
-                Q_EMIT passiveMessage(reply.error().message());
-                return;
-            }
-            m_backend->clear();
-            setProgressing(false);
+                enableReadyToReboot();
+            });
         } else {
             PackageKit::Daemon::global()->offline()->trigger(m_offlineUpdateAction);
+            enableReadyToReboot();
         }
-        enableReadyToReboot();
     }
 }
 
@@ -6,22 +6,33 @@
 
 #include "RpmOstreeNotifier.h"
 
+#include <QDir>
 #include <QDirIterator>
 #include <QFile>
+#include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QProcess>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QTimer>
 #include <QVersionNumber>
 
+#include <algorithm>
+
 #include "libdiscover_rpm-ostree_debug.h"
 
+using namespace std::chrono_literals;
+
 RpmOstreeNotifier::RpmOstreeNotifier(QObject *parent)
     : BackendNotifierModule(parent)
     , m_version(QString())
+    , m_process(nullptr)
     , m_hasUpdates(false)
+    , m_hasSecurityUpdates(false)
     , m_needsReboot(false)
+    , m_recheckPending(false)
 {
     // Refuse to run on systems not managed by rpm-ostree
     if (!isValid()) {
@@ -53,86 +64,216 @@ RpmOstreeNotifier::RpmOstreeNotifier(QObject *parent)
         m_timer->start();
     });
 
+    // The booted deployment can only change with a reboot: reuse what we
+    // found out about it last time instead of waiting on rpm-ostree
+    m_deploymentChecksum = bootedDeploymentChecksum();
+    if (loadCachedStatus()) {
+        return;
+    }
+    loadStatus();
+}
+
+void RpmOstreeNotifier::loadStatus()
+{
     qCInfo(RPMOSTREE_LOG) << "Looking for ostree format";
-    m_process = new QProcess(this);
-    m_stdout = QByteArray();
+    m_loadingStatus = true;
+    auto process = new QProcess(this);
 
     // Display stderr
-    connect(m_process, &QProcess::readyReadStandardError, this, [this]() {
-        qCWarning(RPMOSTREE_LOG) << "rpm-ostree (error):" << m_process->readAllStandardError();
-    });
-
-    // Store stdout to process as JSON
-    connect(m_process, &QProcess::readyReadStandardOutput, this, [this]() {
-        m_stdout += m_process->readAllStandardOutput();
+    connect(process, &QProcess::readyReadStandardError, this, [process]() {
+        qCWarning(RPMOSTREE_LOG) << "rpm-ostree (error):" << process->readAllStandardError();
     });
 
     // Process command result
-    connect(m_process, &QProcess::finished, this, [this](int exitCode, QProcess::ExitStatus exitStatus) {
-        m_process->deleteLater();
-        m_process = nullptr;
+    connect(process, &QProcess::finished, this, [this, process](int exitCode, QProcess::ExitStatus exitStatus) {
+        process->deleteLater();
+        m_loadingStatus = false;
         if (exitStatus != QProcess::NormalExit) {
             qCWarning(RPMOSTREE_LOG) << "Failed to check for existing deployments";
+            statusFailed();
             return;
         }
         if (exitCode != 0) {
             // Unexpected error
             qCWarning(RPMOSTREE_LOG) << "Failed to check for existing deployments. Exit code:" << exitCode;
+            statusFailed();
             return;
         }
 
         // Parse stdout as JSON and look at the currently booted deployments to figure out
         // the format used by ostree
-        const QJsonDocument jsonDocument = QJsonDocument::fromJson(m_stdout);
+        const QJsonDocument jsonDocument = QJsonDocument::fromJson(process->readAllStandardOutput());
         if (!jsonDocument.isObject()) {
             qCWarning(RPMOSTREE_LOG) << "Could not parse 'rpm-ostree status' output as JSON";
+            statusFailed();
             return;
         }
         const QJsonArray deployments = jsonDocument.object().value(QLatin1String("deployments")).toArray();
         if (deployments.isEmpty()) {
             qCWarning(RPMOSTREE_LOG) << "Could not find the deployments in 'rpm-ostree status' JSON output";
+            statusFailed();
             return;
         }
-        bool booted;
         for (const QJsonValue &deployment : deployments) {
-            booted = deployment.toObject()[QLatin1String("booted")].toBool();
-            if (!booted) {
-                continue;
+            if (deployment.toObject()[QLatin1String("booted")].toBool()) {
+                setBootedDeployment(deployment.toObject());
+                storeCachedStatus();
+                break;
             }
-            // Look for "classic" ostree origin format first
-            QString origin = deployment.toObject()[QLatin1String("origin")].toString();
-            if (!origin.isEmpty()) {
-                m_ostreeFormat.reset(new ::OstreeFormat(::OstreeFormat::Format::Classic, origin));
-                if (!m_ostreeFormat->isValid()) {
-                    // This should never happen
-                    qCWarning(RPMOSTREE_LOG) << "Invalid origin for classic ostree format:" << origin;
-                }
-            } else {
-                // Then look for OCI container format
-                origin = deployment.toObject()[QLatin1String("container-image-reference")].toString();
-                if (!origin.isEmpty()) {
-                    m_ostreeFormat.reset(new ::OstreeFormat(::OstreeFormat::Format::OCI, origin));
-                    if (!m_ostreeFormat->isValid()) {
-                        // This should never happen
-                        qCWarning(RPMOSTREE_LOG) << "Invalid reference for OCI container ostree format:" << origin;
-                    }
-                } else {
-                    // This should never happen
-                    m_ostreeFormat.reset(new ::OstreeFormat(::OstreeFormat::Format::Unknown, {}));
-                    qCWarning(RPMOSTREE_LOG) << "Could not find a valid remote ostree format for the booted deployment";
-                }
+        }
+        if (!m_ostreeFormat) {
+            qCWarning(RPMOSTREE_LOG) << "Could not find the booted deployment in 'rpm-ostree status' JSON output";
+            statusFailed();
+            return;
+        }
+
+        if (m_recheckPending) {
+            m_recheckPending = false;
+            recheckSystemUpdateNeeded();
+        }
+    });
+
+    process->start(QStringLiteral("rpm-ostree"), {QStringLiteral("status"), QStringLiteral("--json")});
+}
+
+void RpmOstreeNotifier::statusFailed()
+{
+    // Give rpm-ostree some time before asking again, later checks retry as well
+    if (m_recheckPending) {
+        QTimer::singleShot(1min, this, [this] {
+            if (!m_ostreeFormat && !m_loadingStatus) {
+                loadStatus();
             }
-            // Look for the base-version first. This is the case where we have changes layered
-            m_version = deployment.toObject()[QLatin1String("base-version")].toString();
-            if (m_version.isEmpty()) {
-                // If empty, look for the regular version (no layered changes)
-                m_version = deployment.toObject()[QLatin1String("version")].toString();
+        });
+    }
+}
+
+void RpmOstreeNotifier::setBootedDeployment(const QJsonObject &deployment)
+{
+    // Look for "classic" ostree origin format first
+    QString origin = deployment[QLatin1String("origin")].toString();
+    if (!origin.isEmpty()) {
+        m_ostreeFormat.reset(new ::OstreeFormat(::OstreeFormat::Format::Classic, origin));
+        if (!m_ostreeFormat->isValid()) {
+            // This should never happen
+            qCWarning(RPMOSTREE_LOG) << "Invalid origin for classic ostree format:" << origin;
+        }
+    } else {
+        // Then look for OCI container format
+        origin = deployment[QLatin1String("container-image-reference")].toString();
+        if (!origin.isEmpty()) {
+            m_ostreeFormat.reset(new ::OstreeFormat(::OstreeFormat::Format::OCI, origin));
+            if (!m_ostreeFormat->isValid()) {
+                // This should never happen
+                qCWarning(RPMOSTREE_LOG) << "Invalid reference for OCI container ostree format:" << origin;
             }
+        } else {
+            // This should never happen
+            m_ostreeFormat.reset(new ::OstreeFormat(::OstreeFormat::Format::Unknown, {}));
+            qCWarning(RPMOSTREE_LOG) << "Could not find a valid remote ostree format for the booted deployment";
         }
-    });
+    }
+    // Look for the base-version first. This is the case where we have changes layered
+    m_version = deployment[QLatin1String("base-version")].toString();
+    if (m_version.isEmpty()) {
+        // If empty, look for the regular version (no layered changes)
+        m_version = deployment[QLatin1String("version")].toString();
+    }
+    m_bootedDeployment = deployment;
+}
 
-    m_process->start(QStringLiteral("rpm-ostree"), {QStringLiteral("status"), QStringLiteral("--json")});
-    m_process->waitForFinished();
+QString RpmOstreeNotifier::bootedDeploymentChecksum()
+{
+    // The ostree= kernel argument points to a symlink to the booted deployment
+    // directory, named after its commit checksum
+    QFile cmdline(QStringLiteral("/proc/cmdline"));
+    if (!cmdline.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    const QString arguments = QString::fromUtf8(cmdline.readAll()).trimmed();
+    for (const QStringView argument : QStringView(arguments).split(QLatin1Char(' '), Qt::SkipEmptyParts)) {
+        if (argument.startsWith(QLatin1String("ostree="))) {
+            const QFileInfo deployment(argument.mid(QStringLiteral("ostree=").length()).toString());
+            const QString target = deployment.canonicalFilePath();
+            return target.isEmpty() ? QString() : QFileInfo(target).fileName();
+        }
+    }
+    return {};
+}
+
+static QString bootId()
+{
+    QFile file(QStringLiteral("/proc/sys/kernel/random/boot_id"));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    return QString::fromUtf8(file.readAll()).trimmed();
+}
+
+static QString cachedStatusPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/rpm-ostree/status.json");
+}
+
+bool RpmOstreeNotifier::loadCachedStatus()
+{
+    if (m_deploymentChecksum.isEmpty()) {
+        return false;
+    }
+
+    QFile file(cachedStatusPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QJsonObject cache = QJsonDocument::fromJson(file.readAll()).object();
+    if (cache.value(QLatin1String("deployment")).toString() != m_deploymentChecksum) {
+        qCInfo(RPMOSTREE_LOG) << "Booted deployment changed, discarding cached status";
+        return false;
+    }
+
+    qCInfo(RPMOSTREE_LOG) << "Using cached status for deployment" << m_deploymentChecksum;
+    setBootedDeployment(cache.value(QLatin1String("booted")).toObject());
+
+    // A pending deployment is only pending until the next boot
+    if (cache.value(QLatin1String("bootId")).toString() == bootId() && cache.value(QLatin1String("needsReboot")).toBool()) {
+        m_updateVersion = cache.value(QLatin1String("updateVersion")).toString();
+        m_needsReboot = true;
+        QTimer::singleShot(0, this, [this] {
+            Q_EMIT needsRebootChanged();
+        });
+    }
+    return true;
+}
+
+void RpmOstreeNotifier::storeCachedStatus() const
+{
+    if (m_deploymentChecksum.isEmpty() || m_bootedDeployment.isEmpty()) {
+        return;
+    }
+
+    const QString path = cachedStatusPath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(RPMOSTREE_LOG) << "Could not write the status cache" << path << file.errorString();
+        return;
+    }
+
+    QJsonObject booted;
+    for (const auto key : {QLatin1String("origin"), QLatin1String("container-image-reference"), QLatin1String("base-version"), QLatin1String("version")}) {
+        if (m_bootedDeployment.contains(key)) {
+            booted.insert(key, m_bootedDeployment.value(key));
+        }
+    }
+    const QJsonObject cache{
+        {QLatin1String("deployment"), m_deploymentChecksum},
+        {QLatin1String("bootId"), bootId()},
+        {QLatin1String("booted"), booted},
+        {QLatin1String("updateVersion"), m_updateVersion},
+        {QLatin1String("needsReboot"), m_needsReboot},
+    };
+    file.write(QJsonDocument(cache).toJson(QJsonDocument::Compact));
+    file.commit();
 }
 
 bool RpmOstreeNotifier::isValid() const
@@ -148,6 +289,16 @@ void RpmOstreeNotifier::recheckSystemUpdateNeeded()
         return;
     }
 
+    // The status is still being loaded, check once we know the ostree format
+    if (!m_ostreeFormat) {
+        m_recheckPending = true;
+        if (!m_loadingStatus) {
+            // Loading it failed before, try again
+            loadStatus();
+        }
+        return;
+    }
+
     qCInfo(RPMOSTREE_LOG) << "Checking for system update";
     if (m_ostreeFormat->isClassic()) {
         checkSystemUpdateClassic();
@@ -193,44 +344,90 @@ void RpmOstreeNotifier::checkSystemUpdateClassic()
             return;
         }
 
-        // We have an update available. Let's look if we already have a pending
-        // deployment for the new version. First, look for the new version
-        // string in rpm-ostree stdout
-        QString newVersion, line;
-        QString output = QString::fromUtf8(m_stdout);
-        QTextStream stream(&output);
-        while (stream.readLineInto(&line)) {
-            if (line.contains(QLatin1String("Version: "))) {
-                newVersion = line;
-                break;
+        // We have an update available. The daemon cached its details, read
+        // them from the structured status output.
+        checkCachedUpdate(m_stdout);
+    });
+
+    m_process->start(QStringLiteral("rpm-ostree"), {QStringLiteral("update"), QStringLiteral("--check")});
+}
+
+void RpmOstreeNotifier::checkCachedUpdate(const QByteArray &checkOutput)
+{
+    m_process = new QProcess(this);
+    m_stdout = QByteArray();
+
+    // Display stderr
+    connect(m_process, &QProcess::readyReadStandardError, this, [this]() {
+        qCWarning(RPMOSTREE_LOG) << "rpm-ostree (error):" << m_process->readAllStandardError();
+    });
+
+    // Store stdout to process as JSON
+    connect(m_process, &QProcess::readyReadStandardOutput, this, [this]() {
+        m_stdout += m_process->readAllStandardOutput();
+    });
+
+    // Process command result
+    connect(m_process, &QProcess::finished, this, [this, checkOutput](int exitCode, QProcess::ExitStatus exitStatus) {
+        m_process->deleteLater();
+        m_process = nullptr;
+
+        QString newVersion;
+        bool hasSecurityUpdates = false;
+        if (exitStatus == QProcess::NormalExit && exitCode == 0) {
+            const QJsonObject cachedUpdate = QJsonDocument::fromJson(m_stdout).object().value(QLatin1String("cached-update")).toObject();
+            newVersion = cachedUpdate.value(QLatin1String("version")).toString();
+
+            // Advisories are (id, kind, severity, cves, references) tuples,
+            // kind 1 being a security advisory
+            const QJsonArray advisories = cachedUpdate.value(QLatin1String("advisories")).toArray();
+            hasSecurityUpdates = std::any_of(advisories.cbegin(), advisories.cend(), [](const QJsonValue &advisory) {
+                return advisory.toArray().at(1).toInt() == 1;
+            });
+        } else {
+            qCWarning(RPMOSTREE_LOG) << "Failed to read the cached update from 'rpm-ostree status'";
+        }
+
+        if (newVersion.isEmpty()) {
+            // Older rpm-ostree releases: look for the new version string in the
+            // 'rpm-ostree update --check' output
+            QString line;
+            QString output = QString::fromUtf8(checkOutput);
+            QTextStream stream(&output);
+            while (stream.readLineInto(&line)) {
+                if (line.contains(QLatin1String("Version: "))) {
+                    newVersion = line.trimmed();
+                    newVersion.remove(0, QStringLiteral("Version: ").length());
+                    newVersion.remove(newVersion.size() - QStringLiteral(" (XXXX-XX-XXTXX:XX:XXZ)").length(), newVersion.size() - 1);
+                    break;
+                }
             }
         }
 
-        // Could not find the new version in rpm-ostree output. This is unlikely
-        // to ever happen.
+        // Could not find the new version. This is unlikely to ever happen.
         if (newVersion.isEmpty()) {
             qCInfo(RPMOSTREE_LOG) << "Could not find the version for the update available";
             return;
         }
+        qCInfo(RPMOSTREE_LOG) << "Found new version:" << newVersion << "security:" << hasSecurityUpdates;
+        m_hasSecurityUpdates = hasSecurityUpdates;
+        offerUpdate(newVersion);
+    });
 
-        // Process the string to get just the version "number".
-        newVersion = newVersion.trimmed();
-        newVersion.remove(0, QStringLiteral("Version: ").length());
-        newVersion.remove(newVersion.size() - QStringLiteral(" (XXXX-XX-XXTXX:XX:XXZ)").length(), newVersion.size() - 1);
-        qCInfo(RPMOSTREE_LOG) << "Found new version:" << newVersion;
-
-        // Have we already notified the user about this update?
-        if (newVersion == m_updateVersion) {
-            qCInfo(RPMOSTREE_LOG) << "New version has already been offered. Skipping.";
-            return;
-        }
-        m_updateVersion = newVersion;
+    m_process->start(QStringLiteral("rpm-ostree"), {QStringLiteral("status"), QStringLiteral("--json")});
+}
 
-        // Look for an existing deployment with this version
-        checkForPendingDeployment();
-    });
+void RpmOstreeNotifier::offerUpdate(const QString &newVersion)
+{
+    // Have we already notified the user about this update?
+    if (newVersion == m_updateVersion) {
+        qCInfo(RPMOSTREE_LOG) << "New version has already been offered. Skipping.";
+        return;
+    }
+    m_updateVersion = newVersion;
 
-    m_process->start(QStringLiteral("rpm-ostree"), {QStringLiteral("update"), QStringLiteral("--check")});
+    // Look for an existing deployment with this version
+    checkForPendingDeployment();
 }
 
 void RpmOstreeNotifier::checkSystemUpdateOCI()
@@ -295,15 +492,7 @@ void RpmOstreeNotifier::checkSystemUpdateOCI()
             return;
         }
 
-        // Have we already notified the user about this update?
-        if (newVersion == m_updateVersion) {
-            qCInfo(RPMOSTREE_LOG) << "New version has already been offered. Skipping.";
-            return;
-        }
-        m_updateVersion = newVersion;
-
-        // Look for an existing deployment with this version
-        checkForPendingDeployment();
+        offerUpdate(newVersion);
     });
 
     m_process->start(QStringLiteral("skopeo"),
@@ -371,6 +560,7 @@ void RpmOstreeNotifier::checkForPendingDeployment()
                 if (!m_needsReboot) {
                     qCInfo(RPMOSTREE_LOG) << "Notifying that a reboot is needed";
                     m_needsReboot = true;
+                    storeCachedStatus();
                     Q_EMIT needsRebootChanged();
                 }
                 return;
@@ -381,8 +571,6 @@ void RpmOstreeNotifier::checkForPendingDeployment()
         qCInfo(RPMOSTREE_LOG) << "Notifying that a new update is available";
         m_hasUpdates = true;
         Q_EMIT foundUpdates();
-
-        // TODO: Look for security updates fixed by this new deployment
     });
 
     m_process->start(QStringLiteral("rpm-ostree"), {QStringLiteral("status"), QStringLiteral("--json")});
@@ -390,7 +578,7 @@ void RpmOstreeNotifier::checkForPendingDeployment()
 
 bool RpmOstreeNotifier::hasSecurityUpdates()
 {
-    return false;
+    return m_hasUpdates && m_hasSecurityUpdates;
 }
 
 bool RpmOstreeNotifier::needsReboot() const
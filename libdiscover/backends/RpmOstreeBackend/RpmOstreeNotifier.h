@@ -12,6 +12,7 @@
 
 #include <QDebug>
 #include <QFileSystemWatcher>
+#include <QJsonObject>
 #include <QProcess>
 #include <QTimer>
 
@@ -36,6 +37,21 @@ private:
     /* Only run this code if we are on an rpm-ostree managed system */
     bool isValid() const;
 
+    /* Look at the booted deployment with 'rpm-ostree status' without blocking */
+    void loadStatus();
+    void statusFailed();
+
+    /* Read the ostree format and version from the booted deployment */
+    void setBootedDeployment(const QJsonObject &deployment);
+
+    /* Checksum of the booted deployment, found from the kernel command line */
+    static QString bootedDeploymentChecksum();
+
+    /* The status cache is only valid for the booted deployment, and the
+     * pending deployment state only until the next boot */
+    bool loadCachedStatus();
+    void storeCachedStatus() const;
+
     /* Called by recheckSystemUpdateNeeded to check for system update when the classic
      * ostree format is used. */
     void checkSystemUpdateClassic();
@@ -44,12 +60,24 @@ private:
      * ostree format is used. */
     void checkSystemUpdateOCI();
 
+    /* Read the update found by 'rpm-ostree update --check' from the
+     * 'cached-update' entry in the JSON status. The check output is only
+     * parsed as a fallback. */
+    void checkCachedUpdate(const QByteArray &checkOutput);
+
+    /* Offer the update for the given version unless we already did */
+    void offerUpdate(const QString &newVersion);
+
     /* Store which format is used for the ostree image */
     QScopedPointer<::OstreeFormat> m_ostreeFormat;
 
     /* Store the version of the currently booted deployment */
     QString m_version;
 
+    /* The booted deployment as reported by 'rpm-ostree status' and its checksum */
+    QJsonObject m_bootedDeployment;
+    QString m_deploymentChecksum;
+
     /* Tracks the rpm-ostree command used to check for updates or to look at the
      * status. */
     QProcess *m_process;
@@ -68,9 +96,16 @@ private:
     /* Do we have updates available? */
     bool m_hasUpdates;
 
+    /* Does the available update fix security advisories? */
+    bool m_hasSecurityUpdates;
+
     /* Do we need to reboot to apply updates? */
     bool m_needsReboot;
 
+    /* Was an update check requested before the status was loaded? */
+    bool m_recheckPending;
+    bool m_loadingStatus = false;
+
     /* Watcher to trigger a reboot check when deployments are modified */
     QFileSystemWatcher *m_watcher;
 
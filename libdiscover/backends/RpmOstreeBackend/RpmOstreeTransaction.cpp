@@ -8,6 +8,9 @@
 
 #include <KLocalizedString>
 
+#include <QDBusArgument>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
 #include <QDebug>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -17,7 +20,14 @@
 #include "libdiscover_rpm-ostree_debug.h"
 
 static const QString TransactionConnection = QStringLiteral("discover_transaction");
+static const QString ProgressConnection = QStringLiteral("discover_transaction_progress_");
 static const QString DBusServiceName = QStringLiteral("org.projectatomic.rpmostree1");
+static const QString DBusTransactionInterface = QStringLiteral("org.projectatomic.rpmostree1.Transaction");
+
+// Structured progress mapping: the download takes most of the remaining
+// progress, other daemon tasks (rpm-md refresh, package import, ...) half of it.
+static constexpr int DownloadTaskWeight = 75;
+static constexpr int OtherTaskWeight = 50;
 
 RpmOstreeTransaction::RpmOstreeTransaction(QObject *parent,
                                            AbstractResource *resource,
@@ -28,8 +38,14 @@ RpmOstreeTransaction::RpmOstreeTransaction(QObject *parent,
     , m_timer(nullptr)
     , m_operation(operation)
     , m_resource((RpmOstreeResource *)resource)
+    , m_process(nullptr)
     , m_cancelled(false)
     , m_interface(interface)
+    , m_transactionInterface(nullptr)
+    , m_watchAttempts(0)
+    , m_structuredProgress(false)
+    , m_progressTaskBase(0)
+    , m_progressNotReported(false)
 {
     setStatus(Status::SetupStatus);
 
@@ -112,12 +128,15 @@ RpmOstreeTransaction::RpmOstreeTransaction(QObject *parent,
         m_stderr += message;
     });
 
-    // Store stdout output for later and process it to fake progress
+    // Store stdout output for later and process it to fake progress if the
+    // daemon does not report it
     connect(m_process, &QProcess::readyReadStandardOutput, this, [this]() {
         QByteArray message = m_process->readAllStandardOutput();
         qCDebug(RPMOSTREE_LOG) << (m_prog + QStringLiteral(":")) << message;
         m_stdout += message;
-        fakeProgress(message);
+        if (!m_structuredProgress) {
+            fakeProgress(message);
+        }
     });
 
     // Process the result of the transaction once rpm-ostree is done
@@ -129,6 +148,7 @@ RpmOstreeTransaction::RpmOstreeTransaction(QObject *parent,
 
 RpmOstreeTransaction::~RpmOstreeTransaction()
 {
+    stopWatchingDaemonTransaction();
     delete m_timer;
 }
 
@@ -141,6 +161,11 @@ void RpmOstreeTransaction::start()
         setStatus(Status::DownloadingStatus);
         setProgress(5);
         setDownloadSpeed(0);
+
+        // skopeo does not go through the daemon
+        if (m_prog == QLatin1String("rpm-ostree")) {
+            watchDaemonTransaction();
+        }
     }
 }
 
@@ -148,6 +173,7 @@ void RpmOstreeTransaction::processCommand(int exitCode, QProcess::ExitStatus exi
 {
     m_process->deleteLater();
     m_process = nullptr;
+    stopWatchingDaemonTransaction();
     if (exitStatus != QProcess::NormalExit) {
         if (m_cancelled) {
             // If the user requested the transaction to be cancelled then we
@@ -190,24 +216,9 @@ void RpmOstreeTransaction::processCommand(int exitCode, QProcess::ExitStatus exi
     switch (m_operation) {
     case Operation::CheckForUpdate: {
         if (m_resource->isClassic()) {
-            // Look for new version in rpm-ostree stdout
-            QString newVersion, line;
-            QString output = QString::fromUtf8(m_stdout);
-            QTextStream stream(&output);
-            while (stream.readLineInto(&line)) {
-                if (line.contains(QLatin1String("Version: "))) {
-                    newVersion = line;
-                    break;
-                }
-            }
-            // If we found a new version then offer it as an update
-            if (!newVersion.isEmpty()) {
-                newVersion = newVersion.trimmed();
-                newVersion.remove(0, QStringLiteral("Version: ").length());
-                newVersion.remove(newVersion.size() - QStringLiteral(" (XXXX-XX-XXTXX:XX:XXZ)").length(), newVersion.size() - 1);
-                qCInfo(RPMOSTREE_LOG) << "Found new version:" << newVersion;
-                Q_EMIT newVersionFound(newVersion);
-            }
+            // The daemon records the update it found for the booted OS. Reading it finishes the transaction.
+            checkCachedUpdate();
+            return;
         } else if (m_resource->isOCI()) {
             // Parse stdout as JSON and look at the container image labels for the version
             const QJsonDocument jsonDocument = QJsonDocument::fromJson(m_stdout);
@@ -288,6 +299,7 @@ void RpmOstreeTransaction::setupExternalTransaction()
         QString transaction = m_interface->activeTransactionPath();
         if (transaction.isEmpty()) {
             qCInfo(RPMOSTREE_LOG) << "External transaction finished";
+            stopWatchingDaemonTransaction();
             Q_EMIT deploymentsUpdated();
             setStatus(Status::DoneStatus);
             return;
@@ -300,7 +312,9 @@ void RpmOstreeTransaction::setupExternalTransaction()
         } else {
             qCInfo(RPMOSTREE_LOG) << "External transaction '" << transactionInfo.at(0) << "' requested by '" << transactionInfo.at(1);
         }
-        fakeProgress({});
+        if (!m_structuredProgress) {
+            fakeProgress({});
+        }
 
         // Restart the timer
         m_timer->start();
@@ -311,6 +325,211 @@ void RpmOstreeTransaction::setupExternalTransaction()
     setProgress(5);
     setDownloadSpeed(0);
     m_timer->start();
+
+    watchDaemonTransaction();
+}
+
+void RpmOstreeTransaction::watchDaemonTransaction()
+{
+    if (status() >= Status::DoneStatus || m_transactionInterface != nullptr) {
+        return;
+    }
+
+    // The daemon only publishes the transaction once the command line client
+    // has requested the operation, so give it a little time.
+    const QString address = m_interface->activeTransactionPath();
+    if (address.isEmpty()) {
+        if (++m_watchAttempts < 20) {
+            QTimer::singleShot(250, this, &RpmOstreeTransaction::watchDaemonTransaction);
+        } else {
+            qCInfo(RPMOSTREE_LOG) << "Could not attach to the daemon transaction, progress will be estimated";
+            progressNotReported();
+        }
+        return;
+    }
+
+    const QString connectionName = ProgressConnection + QString::number(reinterpret_cast<quintptr>(this), 16);
+    QDBusConnection peerConnection = QDBusConnection::connectToPeer(address, connectionName);
+    if (!peerConnection.isConnected()) {
+        qCWarning(RPMOSTREE_LOG) << "Could not connect to the daemon transaction:" << peerConnection.lastError().message();
+        QDBusConnection::disconnectFromPeer(connectionName);
+        progressNotReported();
+        return;
+    }
+    qCDebug(RPMOSTREE_LOG) << "Watching daemon transaction" << address;
+    m_transactionAddress = address;
+
+    m_transactionInterface = new OrgProjectatomicRpmostree1TransactionInterface(DBusServiceName, QStringLiteral("/"), peerConnection, this);
+    connect(m_transactionInterface, &OrgProjectatomicRpmostree1TransactionInterface::PercentProgress, this, &RpmOstreeTransaction::onPercentProgress);
+    connect(m_transactionInterface, &OrgProjectatomicRpmostree1TransactionInterface::TaskBegin, this, &RpmOstreeTransaction::onTaskMessage);
+    connect(m_transactionInterface, &OrgProjectatomicRpmostree1TransactionInterface::Message, this, &RpmOstreeTransaction::onTaskMessage);
+    connect(m_transactionInterface, &OrgProjectatomicRpmostree1TransactionInterface::Finished, this, [this](bool success, const QString &errorMessage) {
+        qCDebug(RPMOSTREE_LOG) << "Daemon transaction finished:" << success << errorMessage;
+        setDownloadSpeed(0);
+    });
+
+    // The generated signal does not match the struct arguments sent on the
+    // wire, so take the raw message instead.
+    peerConnection.connect(QString(),
+                           QStringLiteral("/"),
+                           DBusTransactionInterface,
+                           QStringLiteral("DownloadProgress"),
+                           this,
+                           SLOT(onDownloadProgress(QDBusMessage)));
+}
+
+void RpmOstreeTransaction::progressNotReported()
+{
+    if (m_progressNotReported) {
+        return;
+    }
+    m_progressNotReported = true;
+    // The name has been shown already, tell the user why the progress looks off
+    if (m_operation == Operation::DownloadOnly || m_operation == Operation::Update || m_operation == Operation::Rebase) {
+        passiveMessage(name());
+    }
+}
+
+void RpmOstreeTransaction::stopWatchingDaemonTransaction()
+{
+    if (m_transactionInterface == nullptr) {
+        return;
+    }
+    qCDebug(RPMOSTREE_LOG) << "Stop watching daemon transaction" << m_transactionAddress;
+    const QString connectionName = m_transactionInterface->connection().name();
+    delete m_transactionInterface;
+    m_transactionInterface = nullptr;
+    m_transactionAddress.clear();
+    QDBusConnection::disconnectFromPeer(connectionName);
+}
+
+void RpmOstreeTransaction::onPercentProgress(const QString &text, uint percentage)
+{
+    m_structuredProgress = true;
+    if (text != m_progressTask) {
+        m_progressTask = text;
+        m_progressTaskBase = progress();
+    }
+    const int taskProgress = m_progressTaskBase + (99 - m_progressTaskBase) * int(qMin(percentage, 100u)) * OtherTaskWeight / 10000;
+    setProgress(qBound(progress(), taskProgress, 99));
+}
+
+void RpmOstreeTransaction::onDownloadProgress(const QDBusMessage &message)
+{
+    const QList<QVariant> arguments = message.arguments();
+    if (arguments.size() != 6) {
+        qCWarning(RPMOSTREE_LOG) << "Unexpected DownloadProgress signal:" << message.signature();
+        return;
+    }
+
+    // content: (fetched, requested)
+    uint fetched = 0;
+    uint requested = 0;
+    const QDBusArgument content = arguments.at(4).value<QDBusArgument>();
+    content.beginStructure();
+    content >> fetched >> requested;
+    content.endStructure();
+
+    // transfer: (bytes transferred, bytes/s)
+    quint64 transferred = 0;
+    quint64 bytesPerSecond = 0;
+    const QDBusArgument transfer = arguments.at(5).value<QDBusArgument>();
+    transfer.beginStructure();
+    transfer >> transferred >> bytesPerSecond;
+    transfer.endStructure();
+
+    m_structuredProgress = true;
+    setStatus(Status::DownloadingStatus);
+    setDownloadSpeed(bytesPerSecond);
+
+    const QString task = QStringLiteral("download");
+    if (m_progressTask != task) {
+        m_progressTask = task;
+        m_progressTaskBase = progress();
+    }
+    if (requested > 0) {
+        const int percentage = int(qMin<quint64>(100, quint64(fetched) * 100 / requested));
+        const int taskProgress = m_progressTaskBase + (99 - m_progressTaskBase) * percentage * DownloadTaskWeight / 10000;
+        setProgress(qBound(progress(), taskProgress, 99));
+    }
+}
+
+void RpmOstreeTransaction::onTaskMessage(const QString &text)
+{
+    qCDebug(RPMOSTREE_LOG) << "Daemon transaction:" << text;
+    if (text.contains(QLatin1String("Applying")) && (text.contains(QLatin1String("overrides")) || text.contains(QLatin1String("overlays")))) {
+        setStatus(Status::CommittingStatus);
+    } else if (text.contains(QLatin1String("Writing OSTree commit")) || text.contains(QLatin1String("Staging deployment"))) {
+        setStatus(Status::CommittingStatus);
+        setCancellable(false);
+    }
+}
+
+// The generated property getters block, ask through org.freedesktop.DBus.Properties instead
+static QDBusPendingCall getProperty(const QDBusConnection &connection, const QString &path, const QString &interface, const QString &name)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(DBusServiceName, path, QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("Get"));
+    message << interface << name;
+    return connection.asyncCall(message);
+}
+
+void RpmOstreeTransaction::checkCachedUpdate()
+{
+    const QDBusConnection connection = m_interface->connection();
+    auto bootedWatcher = new QDBusPendingCallWatcher(
+        getProperty(connection, m_interface->path(), OrgProjectatomicRpmostree1SysrootInterface::staticInterfaceName(), QStringLiteral("Booted")),
+        this);
+    connect(bootedWatcher, &QDBusPendingCallWatcher::finished, this, [this, connection](QDBusPendingCallWatcher *bootedWatcher) {
+        bootedWatcher->deleteLater();
+        const QDBusPendingReply<QDBusVariant> booted = *bootedWatcher;
+        if (booted.isError()) {
+            qCWarning(RPMOSTREE_LOG) << "Could not get the booted OS:" << booted.error().message();
+            finishUpdateCheck({});
+            return;
+        }
+
+        const QString bootedPath = booted.value().variant().value<QDBusObjectPath>().path();
+        auto updateWatcher = new QDBusPendingCallWatcher(
+            getProperty(connection, bootedPath, OrgProjectatomicRpmostree1OSInterface::staticInterfaceName(), QStringLiteral("CachedUpdate")),
+            this);
+        connect(updateWatcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *updateWatcher) {
+            updateWatcher->deleteLater();
+            const QDBusPendingReply<QDBusVariant> update = *updateWatcher;
+            if (update.isError()) {
+                qCWarning(RPMOSTREE_LOG) << "Could not get the cached update:" << update.error().message();
+                finishUpdateCheck({});
+                return;
+            }
+            finishUpdateCheck(qdbus_cast<QVariantMap>(update.value().variant()).value(QStringLiteral("version")).toString());
+        });
+    });
+}
+
+void RpmOstreeTransaction::finishUpdateCheck(QString newVersion)
+{
+    if (newVersion.isEmpty()) {
+        // Look for new version in rpm-ostree stdout
+        QString line;
+        QString output = QString::fromUtf8(m_stdout);
+        QTextStream stream(&output);
+        while (stream.readLineInto(&line)) {
+            if (line.contains(QLatin1String("Version: "))) {
+                newVersion = line.trimmed();
+                newVersion.remove(0, QStringLiteral("Version: ").length());
+                newVersion.remove(newVersion.size() - QStringLiteral(" (XXXX-XX-XXTXX:XX:XXZ)").length(), newVersion.size() - 1);
+                break;
+            }
+        }
+    }
+    // If we found a new version then offer it as an update
+    if (!newVersion.isEmpty()) {
+        qCInfo(RPMOSTREE_LOG) << "Found new version:" << newVersion;
+        Q_EMIT newVersionFound(newVersion);
+    }
+
+    // Always tell the backend to look for a new major version
+    Q_EMIT lookForNextMajorVersion();
+    setStatus(Status::DoneStatus);
 }
 
 void RpmOstreeTransaction::fakeProgress(const QByteArray &msg)
@@ -390,18 +609,29 @@ void RpmOstreeTransaction::proceed()
 
 QString RpmOstreeTransaction::name() const
 {
+    // Container images are pulled without the daemon reporting any progress
+    const bool progressNotReported = m_progressNotReported || (m_resource && m_resource->isOCI());
     switch (m_operation) {
     case Operation::CheckForUpdate:
         return i18n("Checking for a system update");
         break;
     case Operation::DownloadOnly:
-        return i18n("Downloading system update. Please be patient as progress is not reported.");
+        if (progressNotReported) {
+            return i18n("Downloading system update. Please be patient as progress is not reported.");
+        }
+        return i18n("Downloading system update");
         break;
     case Operation::Update:
-        return i18n("Updating the system. Please be patient as progress is not reported.");
+        if (progressNotReported) {
+            return i18n("Updating the system. Please be patient as progress is not reported.");
+        }
+        return i18n("Updating the system");
         break;
     case Operation::Rebase:
-        return i18n("Updating to the next major version. Please be patient as progress is not reported.");
+        if (progressNotReported) {
+            return i18n("Updating to the next major version. Please be patient as progress is not reported.");
+        }
+        return i18n("Updating to the next major version");
         break;
     case Operation::Unknown:
         return i18n("Operation in progress (started outside of Discover)");
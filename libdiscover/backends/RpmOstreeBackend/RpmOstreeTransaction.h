@@ -72,13 +72,42 @@ public Q_SLOTS:
     /* Process the result of rpm-ostree commands */
     void processCommand(int exitCode, QProcess::ExitStatus exitStatus);
 
+private Q_SLOTS:
+    /* Structured download progress reported by the rpm-ostree daemon. The
+     * signal arguments are structs so we demarshall them by hand. */
+    void onDownloadProgress(const QDBusMessage &message);
+
 private:
     /* Timer setup for transactions started externally from Discover */
     void setupExternalTransaction();
 
-    /* We don't have clear progress info, so we're faking it */
+    /* Attach to the transaction running in the rpm-ostree daemon to receive
+     * its progress signals. Retries until the daemon has published it. */
+    void watchDaemonTransaction();
+
+    /* Drop the peer connection to the daemon transaction, if any */
+    void stopWatchingDaemonTransaction();
+
+    /* Progress and status updates from the daemon transaction signals */
+    void onPercentProgress(const QString &text, uint percentage);
+    void onTaskMessage(const QString &text);
+
+    /* Only used as a fallback when the daemon does not report structured
+     * progress (skopeo calls or if we could not attach to the transaction) */
     void fakeProgress(const QByteArray &message);
 
+    /* Called when the daemon can not report structured progress, tells the
+     * user that the progress is estimated */
+    void progressNotReported();
+
+    /* Read the version of the update found by the last check, as recorded by
+     * the daemon in the CachedUpdate property of the booted OS, then finish */
+    void checkCachedUpdate();
+
+    /* Offer @p newVersion as an update, falling back to the version printed by
+     * rpm-ostree if empty, and complete the transaction */
+    void finishUpdateCheck(QString newVersion);
+
     /* Timer wokaround for Transaction updates when the transaction has not been
      * started by Discover */
     QTimer *m_timer;
@@ -109,4 +138,24 @@ private:
 
     /* Store standard error output from rpm-ostree command line calls */
     QByteArray m_stderr;
+
+    /* Interface to the daemon transaction over a peer to peer connection */
+    OrgProjectatomicRpmostree1TransactionInterface *m_transactionInterface;
+
+    /* Address of the daemon transaction we are attached to */
+    QString m_transactionAddress;
+
+    /* Number of attempts made to attach to the daemon transaction */
+    int m_watchAttempts;
+
+    /* Set once the daemon reported structured progress for this transaction */
+    bool m_structuredProgress;
+
+    /* Daemon task currently reporting progress and the overall progress at
+     * which it started, used to map per task percentages to overall progress */
+    QString m_progressTask;
+    int m_progressTaskBase;
+
+    /* Set when we could not attach to the daemon transaction */
+    bool m_progressNotReported;
 };
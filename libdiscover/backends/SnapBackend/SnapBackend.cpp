@@ -20,7 +20,10 @@
 #include <KLocalizedString>
 #include <KPluginFactory>
 #include <KSharedConfig>
+#include <QDeadlineTimer>
 #include <QDebug>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
 #include <QFuture>
 #include <QFutureWatcher>
 #include <QStandardItemModel>
@@ -95,6 +98,15 @@ SnapBackend::SnapBackend(QObject *parent)
     // make sure we populate the installed resources first
     refreshStates();
 
+    // snapd keeps a file per installed revision, notice when snaps come and go behind our back
+    const QString snapsDir = QStringLiteral("/var/lib/snapd/snaps");
+    if (QFileInfo::exists(snapsDir)) {
+        m_snapsWatcher = new QFileSystemWatcher({snapsDir}, this);
+        connect(m_snapsWatcher, &QFileSystemWatcher::directoryChanged, this, [this] {
+            m_statesExpiry = QDeadlineTimer();
+        });
+    }
+
     SourcesModel::global()->addSourcesBackend(new SnapSourcesBackend(this));
 
     m_threadPool.setMaxThreadCount(1);
@@ -126,17 +138,123 @@ ResultsStream *SnapBackend::search(const AbstractResourcesBackend::Filters &filt
     } else if (filters.category && filters.category->type() == Category::Type::Addon) {
         return voidStream();
     } else if (filters.state >= AbstractResource::Installed || filters.origin == QLatin1String("Snap")) {
+        // Once we know what's installed, there's no need to ask snapd again
+        if (!m_statesExpiry.hasExpired()) {
+            return new ResultsStream(QStringLiteral("Snap-installed"), indexedResources(filters.search, true));
+        }
+        if (!m_refreshingStates) {
+            refreshStates();
+        }
         std::function<bool(const QSharedPointer<QSnapdSnap> &)> f = [filters](const QSharedPointer<QSnapdSnap> &s) {
-            return filters.search.isEmpty() || s->name().contains(filters.search, Qt::CaseInsensitive)
-                || s->description().contains(filters.search, Qt::CaseInsensitive);
+            return filters.search.isEmpty() || matchesSearch(s, filters.search);
         };
         return populateWithFilter(m_client.getSnaps(), f);
     } else if (!filters.search.isEmpty()) {
-        return populate(m_client.find(QSnapdClient::FindFlag::None, filters.search));
+        return findInStore(filters.search);
     }
     return voidStream();
 }
 
+bool SnapBackend::matchesSearch(const QSharedPointer<QSnapdSnap> &snap, const QString &search)
+{
+    return snap->name().contains(search, Qt::CaseInsensitive) || snap->title().contains(search, Qt::CaseInsensitive)
+        || snap->summary().contains(search, Qt::CaseInsensitive) || snap->description().contains(search, Qt::CaseInsensitive);
+}
+
+QVector<StreamResult> SnapBackend::indexedResources(const QString &search, bool installedOnly) const
+{
+    QVector<StreamResult> ret;
+    for (SnapResource *res : m_resources) {
+        if (installedOnly && res->state() < AbstractResource::Installed) {
+            continue;
+        }
+        if (search.isEmpty() || matchesSearch(res->snap(), search)) {
+            ret += res;
+        }
+    }
+    return ret;
+}
+
+ResultsStream *SnapBackend::findInStore(const QString &search)
+{
+    auto stream = new ResultsStream(QStringLiteral("Snap-find"));
+
+    // Whatever we already know about is offered straight away, snapd then
+    // only has to complete the results
+    const QVector<StreamResult> known = indexedResources(search, false);
+    QSet<QString> emitted;
+    for (const StreamResult &result : known) {
+        emitted.insert(result.resource->packageName());
+    }
+
+    const FindResult *cached = m_findCache.object(search);
+    if (cached && !cached->expiry.hasExpired()) {
+        QVector<StreamResult> ret = known;
+        for (const QString &name : cached->names) {
+            SnapResource *res = m_resources.value(name);
+            if (res && !emitted.contains(name)) {
+                ret += res;
+            }
+        }
+        QTimer::singleShot(0, stream, [stream, ret] {
+            if (!ret.isEmpty()) {
+                Q_EMIT stream->resourcesFound(ret);
+            }
+            stream->finish();
+        });
+        return stream;
+    }
+
+    if (!known.isEmpty()) {
+        QTimer::singleShot(0, stream, [stream, known] {
+            Q_EMIT stream->resourcesFound(known);
+        });
+    }
+
+    auto job = m_client.find(QSnapdClient::FindFlag::None, search);
+    auto future = QtConcurrent::run(&m_threadPool, [this, job]() {
+        connect(this, &SnapBackend::shuttingDown, job, &QSnapdFindRequest::cancel);
+        job->runSync();
+    });
+
+    auto watcher = new QFutureWatcher<void>(this);
+    watcher->setFuture(future);
+    connect(watcher, &QFutureWatcher<void>::finished, watcher, &QObject::deleteLater);
+    connect(watcher, &QFutureWatcher<void>::finished, stream, [this, job, search, emitted, stream] {
+        job->deleteLater();
+        if (job->error()) {
+            // Offline or snapd is unavailable, what we had will have to do
+            qDebug() << "error:" << job->error() << job->errorString();
+            stream->finish();
+            return;
+        }
+
+        QStringList names;
+        QVector<StreamResult> ret;
+        for (int i = 0, c = job->snapCount(); i < c; ++i) {
+            QSharedPointer<QSnapdSnap> snap(job->snap(i));
+            const auto snapname = snap->name();
+            SnapResource *&res = m_resources[snapname];
+            if (!res) {
+                res = new SnapResource(snap, AbstractResource::None, this);
+                Q_ASSERT(res->packageName() == snapname);
+            } else {
+                res->setSnap(snap);
+            }
+            names += snapname;
+            if (!emitted.contains(snapname)) {
+                ret += res;
+            }
+        }
+        m_findCache.insert(search, new FindResult{names, QDeadlineTimer(s_findCacheMaxAge)});
+
+        if (!ret.isEmpty())
+            Q_EMIT stream->resourcesFound(ret);
+        stream->finish();
+    });
+    return stream;
+}
+
 ResultsStream *SnapBackend::findResourceByPackageName(const QUrl &search)
 {
     Q_ASSERT(!search.host().isEmpty() || !AppStreamUtils::appstreamIds(search).isEmpty());
@@ -274,6 +392,7 @@ QString SnapBackend::displayName() const
 
 void SnapBackend::refreshStates()
 {
+    m_refreshingStates = true;
     auto ret = new StoredResultsStream({populate(m_client.getSnaps())});
     connect(ret, &StoredResultsStream::finishedResources, this, [this](const QVector<StreamResult> &resources) {
         for (auto res : std::as_const(m_resources)) {
@@ -286,6 +405,8 @@ void SnapBackend::refreshStates()
             else
                 res->setState(AbstractResource::None);
         }
+        m_refreshingStates = false;
+        m_statesExpiry.setRemainingTime(s_statesMaxAge);
         checkForUpdates();
     });
 }
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <QCache>
+#include <QDeadlineTimer>
 #include <QPointer>
 #include <QThreadPool>
 #include <QVariantList>
@@ -16,6 +18,7 @@
 #include <resources/AbstractResourcesBackend.h>
 #include <resources/StoredResultsStream.h>
 
+class QFileSystemWatcher;
 class OdrsReviewsBackend;
 class StandardBackendUpdater;
 class SnapResource;
@@ -72,6 +75,24 @@ private:
     template<class T>
     ResultsStream *populate(const QVector<T *> &snaps);
 
+    static bool matchesSearch(const QSharedPointer<QSnapdSnap> &snap, const QString &search);
+    QVector<StreamResult> indexedResources(const QString &search, bool installedOnly) const;
+    ResultsStream *findInStore(const QString &search);
+
+    // The snaps the store returned for recent queries, all of them in m_resources
+    struct FindResult {
+        QStringList names;
+        QDeadlineTimer expiry;
+    };
+    static constexpr std::chrono::minutes s_findCacheMaxAge{10};
+    QCache<QString, FindResult> m_findCache{50};
+    // Until when the installed states we know can be trusted, snaps can also be
+    // installed and removed without us
+    static constexpr std::chrono::minutes s_statesMaxAge{5};
+    QDeadlineTimer m_statesExpiry;
+    bool m_refreshingStates = false;
+    QFileSystemWatcher *m_snapsWatcher = nullptr;
+
     QHash<QString, SnapResource *> m_resources;
     StandardBackendUpdater *m_updater;
     QSharedPointer<OdrsReviewsBackend> m_reviews;
@@ -13,8 +13,16 @@
 #include <KLocalizedString>
 #include <QCoro/QCoroDBusPendingReply>
 #include <QCoro/QCoroNetworkReply>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QList>
 #include <QNetworkReply>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QtPreprocessorSupport>
 #include <appstream/AppStreamIntegration.h>
 #include <resources/AbstractResource.h>
@@ -37,7 +45,7 @@ SystemdSysupdateBackend::SystemdSysupdateBackend(QObject *parent)
 
     connect(m_manager, &org::freedesktop::sysupdate1::Manager::JobRemoved, this, &SystemdSysupdateBackend::transactionRemoved);
     connect(m_updater, &StandardBackendUpdater::updatesCountChanged, this, &SystemdSysupdateBackend::updatesCountChanged);
-    QTimer::singleShot(0, this, &SystemdSysupdateBackend::checkForUpdates);
+    initialize();
 }
 
 int SystemdSysupdateBackend::updatesCount() const
@@ -47,9 +55,34 @@ int SystemdSysupdateBackend::updatesCount() const
 
 bool SystemdSysupdateBackend::isValid() const
 {
-    auto ping = org::freedesktop::DBus::Peer(SYSUPDATE1_SERVICE, path, OUR_BUS()).Ping();
-    ping.waitForFinished();
-    return !ping.isError();
+    return m_valid;
+}
+
+QCoro::Task<> SystemdSysupdateBackend::initialize()
+{
+    // Activating sysupdated can take a while, or time out when it is not
+    // installed. Show what we found last time in the meantime and stay in the
+    // fetching state until we know whether the service is there.
+    loadCachedTargets();
+    beginFetch();
+
+    const auto ping = co_await org::freedesktop::DBus::Peer(SYSUPDATE1_SERVICE, path, OUR_BUS()).Ping();
+    if (ping.isError()) {
+        qCInfo(SYSTEMDSYSUPDATE_LOG) << "systemd-sysupdate is not available:" << ping.error().message();
+        m_valid = false;
+        const auto targetNames = m_resources.keys();
+        for (const auto &targetName : targetNames) {
+            removeResource(targetName);
+        }
+        QFile::remove(cachedTargetsPath());
+        Q_EMIT invalidated();
+        // Lets the resources model discard us
+        endFetch();
+        co_return;
+    }
+
+    endFetch();
+    checkForUpdates();
 }
 
 ResultsStream *SystemdSysupdateBackend::search(const AbstractResourcesBackend::Filters &filter)
@@ -62,7 +95,7 @@ ResultsStream *SystemdSysupdateBackend::search(const AbstractResourcesBackend::F
     // Since we'll only ever have a handful of targets, we can just return all of them
     QVector<StreamResult> results;
     for (const auto &resource : std::as_const(m_resources)) {
-        if (resource->state() < filter.state) {
+        if (!resource || resource->state() < filter.state) {
             continue;
         }
 
@@ -125,17 +158,17 @@ QCoro::Task<> SystemdSysupdateBackend::checkForUpdatesAsync()
 
     beginFetch();
 
-    for (const auto &resource : m_resources) {
-        Q_EMIT resourceRemoved(resource);
-    }
-    m_resources.clear();
-
     const auto targetsReply = co_await m_manager->ListTargets();
     if (targetsReply.isError()) {
         qCWarning(SYSTEMDSYSUPDATE_LOG) << "Failed to list targets:" << targetsReply.error().message();
+        endFetch();
         co_return;
     }
 
+    // Resources from the previous check (or the cache) stay visible until the
+    // fresh one for the same target is ready
+    QList<CachedTarget> cachedTargets;
+
     // TODO: Make this parallel once QCoro2 is released
     // https://github.com/qcoro/qcoro/issues/250
     const auto targets = targetsReply.value();
@@ -157,6 +190,7 @@ QCoro::Task<> SystemdSysupdateBackend::checkForUpdatesAsync()
 
         qCDebug(SYSTEMDSYSUPDATE_LOG) << "AppStream:" << appStreamUrls;
         AppStream::Metadata metadata;
+        QStringList appStreamDocuments;
         for (const auto &url : appStreamUrls) {
             const auto reply = co_await m_nam->get(QNetworkRequest(QUrl(url)));
             if (reply->error() != QNetworkReply::NoError) {
@@ -179,6 +213,7 @@ QCoro::Task<> SystemdSysupdateBackend::checkForUpdatesAsync()
                 continue;
             } else {
                 qCDebug(SYSTEMDSYSUPDATE_LOG) << "Successfully parsed appstream metadata for target:" << name;
+                appStreamDocuments << data;
             }
         }
 
@@ -209,12 +244,120 @@ QCoro::Task<> SystemdSysupdateBackend::checkForUpdatesAsync()
             continue;
         }
 
-        m_resources << new SystemdSysupdateResource(this, component, {installedVersion, availableVersion}, target);
+        const Sysupdate::TargetInfo targetInfo{installedVersion, availableVersion};
+        setResource(name, new SystemdSysupdateResource(this, component, targetInfo, target));
+        cachedTargets << CachedTarget{name, objectPath.path(), appStreamDocuments, targetInfo};
     }
 
+    // Drop targets that went away or no longer have an update
+    const auto targetNames = m_resources.keys();
+    for (const auto &targetName : targetNames) {
+        const bool found = std::any_of(cachedTargets.cbegin(), cachedTargets.cend(), [&targetName](const CachedTarget &cachedTarget) {
+            return cachedTarget.name == targetName;
+        });
+        if (!found) {
+            removeResource(targetName);
+        }
+    }
+    storeCachedTargets(cachedTargets);
+
     endFetch();
 }
 
+void SystemdSysupdateBackend::setResource(const QString &targetName, SystemdSysupdateResource *resource)
+{
+    removeResource(targetName);
+    m_resources.insert(targetName, resource);
+    Q_EMIT contentsChanged();
+}
+
+void SystemdSysupdateBackend::removeResource(const QString &targetName)
+{
+    const QPointer<SystemdSysupdateResource> resource = m_resources.take(targetName);
+    if (resource) {
+        Q_EMIT resourceRemoved(resource);
+        resource->deleteLater();
+    }
+}
+
+QString SystemdSysupdateBackend::cachedTargetsPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1StringView("/systemd-sysupdate/targets.json");
+}
+
+SystemdSysupdateResource *SystemdSysupdateBackend::createCachedResource(const CachedTarget &cachedTarget)
+{
+    AppStream::Metadata metadata;
+    for (const auto &data : cachedTarget.appStreamDocuments) {
+        const auto format = data.startsWith(QLatin1Char('<')) ? AppStream::Metadata::FormatKindXml : AppStream::Metadata::FormatKindYaml;
+        if (metadata.parse(data, format) != AppStream::Metadata::MetadataErrorNoError) {
+            qCWarning(SYSTEMDSYSUPDATE_LOG) << "Failed to parse cached appstream metadata for target:" << cachedTarget.name << metadata.lastError();
+            return nullptr;
+        }
+    }
+    if (metadata.components().isEmpty()) {
+        return nullptr;
+    }
+
+    auto target = new org::freedesktop::sysupdate1::Target(SYSUPDATE1_SERVICE, cachedTarget.objectPath, OUR_BUS(), this);
+    target->setInteractiveAuthorizationAllowed(true); // in case Update() needs authentication
+    return new SystemdSysupdateResource(this, metadata.component(), cachedTarget.targetInfo, target);
+}
+
+void SystemdSysupdateBackend::loadCachedTargets()
+{
+    QFile file(cachedTargetsPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    const QJsonArray targets = QJsonDocument::fromJson(file.readAll()).array();
+    for (const auto &value : targets) {
+        const QJsonObject object = value.toObject();
+        CachedTarget cachedTarget;
+        cachedTarget.name = object.value(QLatin1StringView("name")).toString();
+        cachedTarget.objectPath = object.value(QLatin1StringView("objectPath")).toString();
+        cachedTarget.targetInfo.installedVersion = object.value(QLatin1StringView("installedVersion")).toString();
+        cachedTarget.targetInfo.availableVersion = object.value(QLatin1StringView("availableVersion")).toString();
+        const QJsonArray documents = object.value(QLatin1StringView("appStream")).toArray();
+        for (const auto &document : documents) {
+            cachedTarget.appStreamDocuments << document.toString();
+        }
+        if (cachedTarget.name.isEmpty() || cachedTarget.objectPath.isEmpty()) {
+            continue;
+        }
+
+        if (auto resource = createCachedResource(cachedTarget)) {
+            qCDebug(SYSTEMDSYSUPDATE_LOG) << "Restored cached target:" << cachedTarget.name;
+            setResource(cachedTarget.name, resource);
+        }
+    }
+}
+
+void SystemdSysupdateBackend::storeCachedTargets(const QList<CachedTarget> &cachedTargets)
+{
+    QJsonArray targets;
+    for (const auto &cachedTarget : cachedTargets) {
+        targets.append(QJsonObject{
+            {QLatin1StringView("name"), cachedTarget.name},
+            {QLatin1StringView("objectPath"), cachedTarget.objectPath},
+            {QLatin1StringView("installedVersion"), cachedTarget.targetInfo.installedVersion},
+            {QLatin1StringView("availableVersion"), cachedTarget.targetInfo.availableVersion},
+            {QLatin1StringView("appStream"), QJsonArray::fromStringList(cachedTarget.appStreamDocuments)},
+        });
+    }
+
+    const QString filePath = cachedTargetsPath();
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(SYSTEMDSYSUPDATE_LOG) << "Failed to write target cache:" << file.errorString();
+        return;
+    }
+    file.write(QJsonDocument(targets).toJson(QJsonDocument::Compact));
+    file.commit();
+}
+
 QString SystemdSysupdateBackend::displayName() const
 {
     return AppStreamIntegration::global()->osRelease()->prettyName();
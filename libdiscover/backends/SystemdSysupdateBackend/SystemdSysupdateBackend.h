@@ -50,14 +50,36 @@ public:
     static QDBusConnection OUR_BUS();
 
 private:
+    /* What we need to recreate a resource without asking sysupdated */
+    struct CachedTarget {
+        QString name;
+        QString objectPath;
+        QStringList appStreamDocuments;
+        Sysupdate::TargetInfo targetInfo;
+    };
+
     void beginFetch();
     void endFetch();
+    QCoro::Task<> initialize();
     QCoro::Task<> checkForUpdatesAsync();
 
+    /* Replace the resource shown for the target, if any */
+    void setResource(const QString &targetName, SystemdSysupdateResource *resource);
+    void removeResource(const QString &targetName);
+
+    SystemdSysupdateResource *createCachedResource(const CachedTarget &cachedTarget);
+    void loadCachedTargets();
+    void storeCachedTargets(const QList<CachedTarget> &cachedTargets);
+    static QString cachedTargetsPath();
+
+    /* Cleared if sysupdated turns out not to be available */
+    bool m_valid = true;
+
     int m_fetchOperationCount = 0;
     StandardBackendUpdater *m_updater;
 
-    QList<QPointer<SystemdSysupdateResource>> m_resources;
+    /* Resources keyed by target name */
+    QHash<QString, QPointer<SystemdSysupdateResource>> m_resources;
     QPointer<org::freedesktop::sysupdate1::Manager> m_manager;
 
     QNetworkAccessManager *m_nam;
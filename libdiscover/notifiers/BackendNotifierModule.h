@@ -8,6 +8,7 @@
 
 #include "DiscoverConfig.h"
 #include "discovernotifiers_export.h"
+#include <QDateTime>
 #include <QObject>
 
 class DISCOVERNOTIFIERS_EXPORT UpgradeAction : public QObject
@@ -66,6 +67,15 @@ public:
     /** @returns whether the system changed in a way that needs to be rebooted. */
     virtual bool needsReboot() const = 0;
 
+    /**
+     * @returns when the updates the module started off with were checked, if it
+     * restored any from an earlier check. Such modules don't need to check again right away.
+     */
+    virtual QDateTime cachedStateChecked() const
+    {
+        return {};
+    }
+
 Q_SIGNALS:
     /**
      * This signal is emitted when any new updates are available.
@@ -0,0 +1,161 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 Plasma Discover contributors
+ *
+ *   SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "UpdatesSnapshot.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+using namespace Qt::StringLiterals;
+
+static constexpr int s_formatVersion = 1;
+
+QString UpdatesSnapshot::path()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericStateLocation) + "/discover/updates-snapshot.json"_L1;
+}
+
+bool UpdatesSnapshot::Backend::isFresh(std::chrono::seconds maxAge) const
+{
+    return checked.isValid() && checked.secsTo(QDateTime::currentDateTimeUtc()) < maxAge.count();
+}
+
+void UpdatesSnapshot::Backend::summarize()
+{
+    count = updates.count();
+    downloadSize = 0;
+    hasSecurityUpdates = false;
+    for (const auto &update : std::as_const(updates)) {
+        downloadSize += update.downloadSize;
+        hasSecurityUpdates |= update.security;
+    }
+}
+
+QDateTime UpdatesSnapshot::checked() const
+{
+    QDateTime ret;
+    for (const auto &backend : m_backends) {
+        if (!ret.isValid() || backend.checked < ret) {
+            ret = backend.checked;
+        }
+    }
+    return ret;
+}
+
+bool UpdatesSnapshot::isFresh(std::chrono::seconds maxAge) const
+{
+    const QDateTime oldest = checked();
+    return oldest.isValid() && oldest.secsTo(QDateTime::currentDateTimeUtc()) < maxAge.count();
+}
+
+UpdatesSnapshot UpdatesSnapshot::load()
+{
+    UpdatesSnapshot ret;
+    QFile file(path());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return ret;
+    }
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root["version"_L1].toInt() != s_formatVersion) {
+        return ret;
+    }
+
+    ret.m_timestamp = QDateTime::fromString(root["timestamp"_L1].toString(), Qt::ISODate);
+    const QJsonObject backends = root["backends"_L1].toObject();
+    for (auto it = backends.constBegin(), itEnd = backends.constEnd(); it != itEnd; ++it) {
+        const QJsonObject object = it->toObject();
+        Backend backend;
+        backend.checked = QDateTime::fromString(object["checked"_L1].toString(), Qt::ISODate);
+        backend.count = object["count"_L1].toInt();
+        backend.downloadSize = object["downloadSize"_L1].toInteger();
+        backend.hasSecurityUpdates = object["hasSecurityUpdates"_L1].toBool();
+        const QJsonArray updates = object["updates"_L1].toArray();
+        backend.updates.reserve(updates.size());
+        for (const auto &value : updates) {
+            const QJsonObject update = value.toObject();
+            backend.updates.append({
+                .id = update["id"_L1].toString(),
+                .summary = update["summary"_L1].toString(),
+                .downloadSize = quint64(update["downloadSize"_L1].toInteger()),
+                .security = update["security"_L1].toBool(),
+                .kind = update["kind"_L1].toInt(),
+            });
+        }
+        ret.m_backends.insert(it.key(), backend);
+    }
+    return ret;
+}
+
+bool UpdatesSnapshot::save() const
+{
+    QJsonObject backends;
+    for (auto it = m_backends.constBegin(), itEnd = m_backends.constEnd(); it != itEnd; ++it) {
+        QJsonArray updates;
+        for (const auto &update : std::as_const(it->updates)) {
+            QJsonObject object{
+                {"id"_L1, update.id},
+                {"summary"_L1, update.summary},
+                {"security"_L1, update.security},
+                {"kind"_L1, update.kind},
+            };
+            if (update.downloadSize > 0) {
+                object.insert("downloadSize"_L1, qint64(update.downloadSize));
+            }
+            updates.append(object);
+        }
+        QJsonObject backend{
+            {"checked"_L1, it->checked.toString(Qt::ISODate)},
+            {"count"_L1, it->count},
+            {"hasSecurityUpdates"_L1, it->hasSecurityUpdates},
+            {"updates"_L1, updates},
+        };
+        if (it->downloadSize > 0) {
+            backend.insert("downloadSize"_L1, qint64(it->downloadSize));
+        }
+        backends.insert(it.key(), backend);
+    }
+
+    const QJsonObject root{
+        {"version"_L1, s_formatVersion},
+        {"timestamp"_L1, m_timestamp.toString(Qt::ISODate)},
+        {"backends"_L1, backends},
+    };
+
+    QSaveFile file(path());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write the updates snapshot" << file.fileName() << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+void UpdatesSnapshot::store(const QString &backendName, const Backend &backend)
+{
+    const QString filePath = path();
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+
+    // Both the notifier and Discover may be writing at once, make sure we don't lose either
+    QLockFile lock(filePath + ".lock"_L1);
+    if (!lock.tryLock(std::chrono::seconds(2))) {
+        qWarning() << "Could not lock the updates snapshot" << lock.error();
+        return;
+    }
+
+    UpdatesSnapshot snapshot = load();
+    snapshot.m_timestamp = QDateTime::currentDateTimeUtc();
+    snapshot.m_backends.insert(backendName, backend);
+    snapshot.save();
+}
@@ -0,0 +1,87 @@
+/*
+ *   SPDX-FileCopyrightText: 2026 Plasma Discover contributors
+ *
+ *   SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#pragma once
+
+#include "discovernotifiers_export.h"
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <chrono>
+
+/**
+ * State of the last update check, shared between the DiscoverNotifier and Discover itself.
+ *
+ * Whichever process checked last writes its findings so that the other one can use them
+ * right away instead of asking the backends all over again.
+ */
+class DISCOVERNOTIFIERS_EXPORT UpdatesSnapshot
+{
+public:
+    struct Update {
+        /// backend-specific identifier, e.g. a PackageKit package id or a flatpak ref
+        QString id;
+        QString summary;
+        /// 0 if the backend doesn't know it, it's left out of the file then
+        quint64 downloadSize = 0;
+        bool security = false;
+        /// backend-specific kind of update, e.g. a PackageKit::Transaction::Info, 0 if unknown
+        int kind = 0;
+    };
+
+    struct Backend {
+        QDateTime checked;
+        QList<Update> updates;
+        int count = 0;
+        quint64 downloadSize = 0;
+        bool hasSecurityUpdates = false;
+
+        bool isValid() const
+        {
+            return checked.isValid();
+        }
+
+        /// @returns whether the check happened less than @p maxAge ago
+        bool isFresh(std::chrono::seconds maxAge = s_maxAge) const;
+
+        /// Fills count, downloadSize and hasSecurityUpdates from @p updates
+        void summarize();
+    };
+
+    /// How long a check is considered to be up to date
+    static constexpr std::chrono::seconds s_maxAge = std::chrono::hours(1);
+
+    /// @returns the state as it was left by the last process that stored something
+    static UpdatesSnapshot load();
+
+    /// Replaces the section of @p backendName in the snapshot with @p backend
+    static void store(const QString &backendName, const Backend &backend);
+
+    Backend backend(const QString &backendName) const
+    {
+        return m_backends.value(backendName);
+    }
+
+    QDateTime timestamp() const
+    {
+        return m_timestamp;
+    }
+
+    /// @returns when the backend that was checked the longest ago was checked
+    QDateTime checked() const;
+
+    /// @returns whether all the backends in the snapshot are fresh
+    bool isFresh(std::chrono::seconds maxAge = s_maxAge) const;
+
+    static QString path();
+
+private:
+    bool save() const;
+
+    QDateTime m_timestamp;
+    QHash<QString, Backend> m_backends;
+};
@@ -104,6 +104,7 @@ class DISCOVERCOMMON_EXPORT AbstractResource : public QObject
     Q_PROPERTY(QString verifiedMessage READ verifiedMessage CONSTANT)
     Q_PROPERTY(QString verifiedIconName READ verifiedIconName CONSTANT)
     Q_PROPERTY(Type type READ type CONSTANT)
+    Q_PROPERTY(bool isPlaceholder READ isPlaceholder CONSTANT)
 
     // Resolve circular dependency for QObject* properties in both classes
     Q_MOC_INCLUDE("resources/AbstractResourcesBackend.h")
@@ -307,6 +308,17 @@ public:
         return false;
     }
 
+    /**
+     * @returns whether the resource only stands in for one the backend hasn't loaded yet
+     *
+     * Placeholders are restored from the last session to fill the lists early,
+     * they can be displayed but not acted upon.
+     */
+    virtual bool isPlaceholder() const
+    {
+        return false;
+    }
+
 public Q_SLOTS:
     virtual void fetchScreenshots();
     virtual void fetchChangelog() = 0;
@@ -12,6 +12,7 @@
 #include "libdiscover_debug.h"
 #include "resources/AbstractBackendUpdater.h"
 #include "resources/AbstractResourcesBackend.h"
+#include "resources/ResourcesSnapshot.h"
 #include "utils.h"
 #include <DiscoverBackendsFactory.h>
 #include <KConfigGroup>
@@ -149,6 +150,7 @@ bool ResourcesModel::addResourcesBackend(AbstractResourcesBackend *backend)
 
     m_backends += backend;
     m_updatesCount.reevaluate();
+    ResourcesSnapshot::global()->addBackend(backend);
 
     connect(backend, &AbstractResourcesBackend::contentsChanged, this, &ResourcesModel::callerContentsChanged);
     connect(backend, &AbstractResourcesBackend::allDataChanged, this, &ResourcesModel::updateCaller);
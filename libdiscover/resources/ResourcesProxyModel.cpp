@@ -14,6 +14,7 @@
 #include <utils.h>
 
 #include "ResourcesModel.h"
+#include "ResourcesSnapshot.h"
 #include <Category/CategoryModel.h>
 #include <KLocalizedString>
 #include <ReviewsBackend/Rating.h>
@@ -139,6 +140,9 @@ ResourcesProxyModel::ResourcesProxyModel(QObject *parent)
     connect(ResourcesModel::global(), &ResourcesModel::backendDataChanged, this, &ResourcesProxyModel::refreshBackend);
     connect(ResourcesModel::global(), &ResourcesModel::resourceDataChanged, this, &ResourcesProxyModel::refreshResource);
     connect(ResourcesModel::global(), &ResourcesModel::resourceRemoved, this, &ResourcesProxyModel::removeResource);
+    connect(ResourcesSnapshot::global(), &ResourcesSnapshot::placeholdersRemoved, this, [this](AbstractResourcesBackend *backend) {
+        takePlaceholders(backend);
+    });
 
     m_countTimer.setInterval(10);
     m_countTimer.setSingleShot(true);
@@ -289,7 +293,8 @@ void ResourcesProxyModel::removeDuplicates(QVector<StreamResult> &resources)
                 it = resources.erase(it);
             }
         } else {
-            if (it->resource->backend() == currentApplicationBackend) {
+            // Placeholders always make way for the live resources
+            if (it->resource->backend() == currentApplicationBackend || (**at).resource->isPlaceholder()) {
                 **at = *it;
                 auto pos = index(*at - m_displayedResources.begin(), 0);
                 Q_EMIT dataChanged(pos, pos);
@@ -303,6 +308,7 @@ void ResourcesProxyModel::addResources(const QVector<StreamResult> &results)
 {
     auto resultsCopy = results;
     m_filters.filterJustInCase(resultsCopy);
+    replacePlaceholders(resultsCopy);
 
     if (resultsCopy.isEmpty()) {
         return;
@@ -315,6 +321,87 @@ void ResourcesProxyModel::addResources(const QVector<StreamResult> &results)
     fetchSubcategories();
 }
 
+void ResourcesProxyModel::replacePlaceholders(QVector<StreamResult> &results)
+{
+    if (!m_hasPlaceholders) {
+        return;
+    }
+
+    QHash<QString, int> placeholderRows;
+    for (int row = 0, count = m_displayedResources.count(); row < count; ++row) {
+        const auto resource = m_displayedResources[row].resource;
+        if (resource->isPlaceholder()) {
+            placeholderRows.insert(ResourcesSnapshot::key(resource), row);
+        }
+    }
+
+    QList<int> replacedRows;
+    for (auto it = results.begin(); it != results.end();) {
+        const auto row = it->resource->isPlaceholder() ? placeholderRows.end() : placeholderRows.find(ResourcesSnapshot::key(it->resource));
+        if (row == placeholderRows.end()) {
+            ++it;
+            continue;
+        }
+
+        m_displayedResources[*row] = *it;
+        replacedRows += *row;
+        placeholderRows.erase(row);
+        it = results.erase(it);
+    }
+
+    // The live data can sort differently, rows that are out of place are inserted again
+    std::sort(replacedRows.begin(), replacedRows.end(), std::greater<>());
+    for (int row : std::as_const(replacedRows)) {
+        const StreamResult result = m_displayedResources[row];
+        const bool afterPrevious = row == 0 || !orderedLessThan(result, m_displayedResources[row - 1]);
+        const bool beforeNext = row == m_displayedResources.count() - 1 || !orderedLessThan(m_displayedResources[row + 1], result);
+        if (afterPrevious && beforeNext) {
+            const QModelIndex idx = index(row, 0);
+            Q_EMIT dataChanged(idx, idx);
+        } else {
+            beginRemoveRows({}, row, row);
+            m_displayedResources.removeAt(row);
+            endRemoveRows();
+            results += result;
+        }
+    }
+}
+
+QVector<AbstractResource *> ResourcesProxyModel::takePlaceholders(AbstractResourcesBackend *backend)
+{
+    QVector<AbstractResource *> ret;
+    if (!m_hasPlaceholders) {
+        return ret;
+    }
+
+    const auto isRemoved = [this, backend](int row) {
+        const auto resource = m_displayedResources[row].resource;
+        return resource->isPlaceholder() && (!backend || resource->backend() == backend);
+    };
+    for (int row = m_displayedResources.count() - 1; row >= 0; --row) {
+        if (!isRemoved(row)) {
+            continue;
+        }
+
+        int first = row;
+        while (first > 0 && isRemoved(first - 1)) {
+            --first;
+        }
+        for (int i = first; i <= row; ++i) {
+            ret += m_displayedResources[i].resource;
+        }
+        beginRemoveRows({}, first, row);
+        m_displayedResources.remove(first, row - first + 1);
+        endRemoveRows();
+        row = first;
+    }
+
+    if (!backend) {
+        m_hasPlaceholders = false;
+    }
+    return ret;
+}
+
 void ResourcesProxyModel::invalidateSorting()
 {
     if (m_displayedResources.isEmpty()) {
@@ -420,6 +507,8 @@ void ResourcesProxyModel::invalidateFilter()
 
     if (m_currentStream) {
         qCWarning(LIBDISCOVER_LOG) << "last stream isn't over yet" << m_filters << this;
+        // Its results are incomplete, don't let them settle the placeholders
+        disconnect(m_currentStream, nullptr, this, nullptr);
         delete m_currentStream;
     }
 
@@ -429,14 +518,25 @@ void ResourcesProxyModel::invalidateFilter()
     if (!m_displayedResources.isEmpty()) {
         beginResetModel();
         m_displayedResources.clear();
+        m_hasPlaceholders = false;
         endResetModel();
     }
 
     connect(m_currentStream, &ResultsStream::resourcesFound, this, &ResourcesProxyModel::addResources);
     connect(m_currentStream, &ResultsStream::destroyed, this, [this]() {
         m_currentStream = nullptr;
+        // Whatever wasn't replaced by now is gone
+        const auto stale = takePlaceholders(nullptr);
+        ResourcesSnapshot::global()->record(m_filters, m_displayedResources, stale);
         Q_EMIT busyChanged();
     });
+
+    // Show what the backends that are still loading had last time
+    const auto placeholders = ResourcesSnapshot::global()->resources(m_filters);
+    if (!placeholders.isEmpty()) {
+        m_hasPlaceholders = true;
+        addResources(placeholders);
+    }
 }
 
 int ResourcesProxyModel::rowCount(const QModelIndex &parent) const
@@ -185,6 +185,9 @@ private:
     void addResources(const QVector<StreamResult> &results);
     void fetchSubcategories();
     void removeDuplicates(QVector<StreamResult> &newResources);
+    void replacePlaceholders(QVector<StreamResult> &results);
+    // Removes the placeholders of @p backend, or all of them if null
+    QVector<AbstractResource *> takePlaceholders(AbstractResourcesBackend *backend);
     bool isSorted(const QVector<StreamResult> &results);
 
     Roles m_sortRole;
@@ -202,6 +205,7 @@ private:
     ResultsStream *m_currentStream;
     QTimer m_countTimer;
     bool m_categorize = false;
+    bool m_hasPlaceholders = false;
 
 Q_SIGNALS:
     void busyChanged();
@@ -0,0 +1,468 @@
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+// SPDX-FileCopyrightText: 2026 Plasma Discover contributors
+
+#include "ResourcesSnapshot.h"
+#include "AbstractResource.h"
+#include "libdiscover_debug.h"
+#include <Category/Category.h>
+#include <ReviewsBackend/Rating.h>
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QIcon>
+#include <QJsonArray>
+#include <QLocale>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrentRun>
+
+using namespace Qt::StringLiterals;
+using namespace std::chrono_literals;
+
+static constexpr quint32 s_snapshotMagic = 0x44534e50; // "DSNP"
+// Bump whenever SnapshotRow changes, older snapshots are then ignored
+static constexpr quint32 s_snapshotVersion = 2;
+static constexpr qsizetype s_maxRows = 5000;
+
+static QDataStream &operator<<(QDataStream &stream, const SnapshotRow &row)
+{
+    return stream << row.key << row.name << row.comment << row.icon << row.sourceIcon << row.packageName << row.appstreamId << row.origin << row.displayOrigin
+                  << row.section << row.installedVersion << row.availableVersion << row.categories << row.type << row.state << row.ratingCount
+                  << row.ratingPoints << row.starCounts << row.releaseDate << row.lastSeen;
+}
+
+static QDataStream &operator>>(QDataStream &stream, SnapshotRow &row)
+{
+    return stream >> row.key >> row.name >> row.comment >> row.icon >> row.sourceIcon >> row.packageName >> row.appstreamId >> row.origin >> row.displayOrigin
+        >> row.section >> row.installedVersion >> row.availableVersion >> row.categories >> row.type >> row.state >> row.ratingCount
+        >> row.ratingPoints >> row.starCounts >> row.releaseDate >> row.lastSeen;
+}
+
+// Rows are stored translated, a snapshot from another language is useless
+static QString snapshotLanguages()
+{
+    return QLocale().uiLanguages().join(u',');
+}
+
+static QHash<QString, SnapshotRow> readSnapshot(const QString &path, const QString &languages)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_5);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString fileLanguages;
+    quint32 count = 0;
+    stream >> magic >> version >> fileLanguages >> count;
+    if (magic != s_snapshotMagic || version != s_snapshotVersion || fileLanguages != languages) {
+        qCDebug(LIBDISCOVER_LOG) << "Ignoring outdated snapshot" << path;
+        return {};
+    }
+
+    QHash<QString, SnapshotRow> rows;
+    rows.reserve(std::min<qsizetype>(count, s_maxRows));
+    for (quint32 i = 0; i < count; ++i) {
+        SnapshotRow row;
+        stream >> row;
+        if (stream.status() != QDataStream::Ok) {
+            qCWarning(LIBDISCOVER_LOG) << "Could not read snapshot" << path;
+            return {};
+        }
+        rows.insert(row.key, row);
+    }
+    return rows;
+}
+
+static void writeSnapshot(const QString &path, const QString &languages, QList<SnapshotRow> rows)
+{
+    // Keep the rows the lists showed most recently
+    if (rows.size() > s_maxRows) {
+        std::nth_element(rows.begin(), rows.begin() + s_maxRows, rows.end(), [](const SnapshotRow &a, const SnapshotRow &b) {
+            return a.lastSeen > b.lastSeen;
+        });
+        rows.resize(s_maxRows);
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(LIBDISCOVER_LOG) << "Could not write snapshot" << path << file.errorString();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_5);
+    stream << s_snapshotMagic << s_snapshotVersion << languages << quint32(rows.size());
+    for (const SnapshotRow &row : std::as_const(rows)) {
+        stream << row;
+    }
+    if (!file.commit()) {
+        qCWarning(LIBDISCOVER_LOG) << "Could not write snapshot" << path << file.errorString();
+    }
+}
+
+static void collectCategoryNames(const CategoryFilter &filter, QSet<QString> &names)
+{
+    if (filter.type == CategoryFilter::CategoryNameFilter) {
+        names.insert(std::get<QString>(filter.value));
+    } else if (const auto filters = std::get_if<QList<CategoryFilter>>(&filter.value)) {
+        for (const CategoryFilter &subFilter : *filters) {
+            collectCategoryNames(subFilter, names);
+        }
+    }
+}
+
+static QString iconKey(const QVariant &icon)
+{
+    switch (icon.typeId()) {
+    case QMetaType::QString:
+        return icon.toString();
+    case QMetaType::QUrl: {
+        // Remote icons would be downloaded again just for the placeholder
+        const QUrl url = icon.toUrl();
+        return url.isLocalFile() ? url.toString() : QString();
+    }
+    default:
+        if (icon.canConvert<QIcon>()) {
+            return icon.value<QIcon>().name();
+        }
+        return {};
+    }
+}
+
+class SnapshotResource : public AbstractResource
+{
+    Q_OBJECT
+public:
+    SnapshotResource(const SnapshotRow &row, AbstractResourcesBackend *backend)
+        : AbstractResource(backend)
+        , m_row(row)
+    {
+    }
+
+    bool isPlaceholder() const override
+    {
+        return true;
+    }
+    QString packageName() const override
+    {
+        return m_row.packageName;
+    }
+    QString name() const override
+    {
+        return m_row.name;
+    }
+    QString comment() override
+    {
+        return m_row.comment;
+    }
+    QVariant icon() const override
+    {
+        return m_row.icon;
+    }
+    bool canExecute() const override
+    {
+        return false;
+    }
+    void invokeApplication() const override
+    {
+    }
+    State state() override
+    {
+        return State(m_row.state);
+    }
+    bool hasCategory(const QString &category) const override
+    {
+        return m_row.categories.contains(category);
+    }
+    Type type() const override
+    {
+        return Type(m_row.type);
+    }
+    quint64 size() override
+    {
+        // Sizes are only known once the backend fetched the details
+        return 0;
+    }
+    QJsonArray licenses() override
+    {
+        return {};
+    }
+    QString installedVersion() const override
+    {
+        return m_row.installedVersion;
+    }
+    QString availableVersion() const override
+    {
+        return m_row.availableVersion;
+    }
+    QString longDescription() override
+    {
+        return {};
+    }
+    QString origin() const override
+    {
+        return m_row.origin;
+    }
+    QString displayOrigin() const override
+    {
+        return m_row.displayOrigin;
+    }
+    QString section() override
+    {
+        return m_row.section;
+    }
+    QString author() const override
+    {
+        return {};
+    }
+    QList<PackageState> addonsInformation() override
+    {
+        return {};
+    }
+    QString appstreamId() const override
+    {
+        return m_row.appstreamId;
+    }
+    QString sourceIcon() const override
+    {
+        return m_row.sourceIcon;
+    }
+    QDate releaseDate() const override
+    {
+        return m_row.releaseDate;
+    }
+    Rating rating() const override
+    {
+        if (m_row.starCounts.size() == 6) {
+            int starCounts[6];
+            std::copy(m_row.starCounts.begin(), m_row.starCounts.end(), starCounts);
+            return Rating(m_row.packageName, m_row.ratingCount, starCounts);
+        }
+        return m_row.ratingCount > 0 ? Rating(m_row.packageName, m_row.ratingCount, m_row.ratingPoints) : Rating();
+    }
+    void fetchChangelog() override
+    {
+    }
+
+private:
+    const SnapshotRow m_row;
+};
+
+ResourcesSnapshot *ResourcesSnapshot::global()
+{
+    static ResourcesSnapshot snapshot;
+    return &snapshot;
+}
+
+ResourcesSnapshot::ResourcesSnapshot()
+    : m_snapshotDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/snapshots"_L1)
+{
+    QDir().mkpath(m_snapshotDir);
+
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(5s);
+    connect(&m_saveTimer, &QTimer::timeout, this, &ResourcesSnapshot::save);
+
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this] {
+        if (m_saveTimer.isActive()) {
+            m_saveTimer.stop();
+            save();
+        }
+        for (auto &write : m_writes) {
+            write.waitForFinished();
+        }
+    });
+}
+
+QString ResourcesSnapshot::snapshotPath(AbstractResourcesBackend *backend) const
+{
+    return m_snapshotDir + QLatin1Char('/') + backend->name() + ".snapshot"_L1;
+}
+
+QString ResourcesSnapshot::key(AbstractResource *resource)
+{
+    return resource->backend()->name() + QLatin1Char('/') + resource->appstreamId() + QLatin1Char('/') + resource->packageName();
+}
+
+bool ResourcesSnapshot::isSnapshotFilter(const AbstractResourcesBackend::Filters &filters)
+{
+    // Only the browse and installed lists, searches depend on live data to be ranked
+    return (filters.category || filters.state >= AbstractResource::Installed) && filters.search.isEmpty() && filters.resourceUrl.isEmpty()
+        && filters.mimetype.isEmpty() && filters.extends.isEmpty() && filters.origin.isEmpty();
+}
+
+void ResourcesSnapshot::addBackend(AbstractResourcesBackend *backend)
+{
+    if (m_backends.contains(backend)) {
+        return;
+    }
+
+    auto &snapshot = m_backends[backend];
+    snapshot.loading = QtConcurrent::run(readSnapshot, snapshotPath(backend), snapshotLanguages());
+    snapshot.backendLoaded = backend->fetchingUpdatesProgress() >= 100;
+
+    connect(backend, &AbstractResourcesBackend::fetchingUpdatesProgressChanged, this, [this, backend] {
+        if (backend->fetchingUpdatesProgress() >= 100) {
+            backendLoaded(backend);
+        }
+    });
+    connect(backend, &QObject::destroyed, this, [this, backend] {
+        // The placeholders are the backend's children, they are gone already
+        m_backends.remove(backend);
+        m_dirty.remove(backend);
+    });
+}
+
+QHash<QString, SnapshotRow> &ResourcesSnapshot::rows(AbstractResourcesBackend *backend)
+{
+    auto &snapshot = m_backends[backend];
+    if (snapshot.loading.isValid()) {
+        snapshot.rows = snapshot.loading.result();
+        snapshot.loading = {};
+    }
+    return snapshot.rows;
+}
+
+QVector<StreamResult> ResourcesSnapshot::resources(const AbstractResourcesBackend::Filters &filters)
+{
+    if (!isSnapshotFilter(filters)) {
+        return {};
+    }
+
+    QVector<StreamResult> ret;
+    for (auto it = m_backends.begin(), itEnd = m_backends.end(); it != itEnd; ++it) {
+        AbstractResourcesBackend *backend = it.key();
+        if (it->backendLoaded || (filters.backend && filters.backend != backend)) {
+            continue;
+        }
+
+        if (!it->placeholdersCreated) {
+            it->placeholdersCreated = true;
+            const auto &backendRows = rows(backend);
+            it->placeholders.reserve(backendRows.size());
+            for (const SnapshotRow &row : backendRows) {
+                it->placeholders += new SnapshotResource(row, backend);
+            }
+        }
+
+        for (AbstractResource *placeholder : std::as_const(it->placeholders)) {
+            if (filters.shouldFilter(placeholder)) {
+                ret += StreamResult(placeholder, 0);
+            }
+        }
+    }
+    return ret;
+}
+
+void ResourcesSnapshot::backendLoaded(AbstractResourcesBackend *backend)
+{
+    auto &snapshot = m_backends[backend];
+    if (snapshot.backendLoaded) {
+        return;
+    }
+    snapshot.backendLoaded = true;
+
+    if (snapshot.placeholders.isEmpty()) {
+        return;
+    }
+
+    // Lists replace the placeholders as their streams finish, give them some time before
+    // pulling the ones that are still around
+    QTimer::singleShot(30s, this, [this, backend] {
+        auto it = m_backends.find(backend);
+        if (it == m_backends.end()) {
+            return;
+        }
+        Q_EMIT placeholdersRemoved(backend);
+        qDeleteAll(std::exchange(it->placeholders, {}));
+    });
+}
+
+void ResourcesSnapshot::record(const AbstractResourcesBackend::Filters &filters, const QVector<StreamResult> &results, const QVector<AbstractResource *> &stale)
+{
+    if (!isSnapshotFilter(filters)) {
+        return;
+    }
+
+    for (AbstractResource *placeholder : stale) {
+        AbstractResourcesBackend *backend = placeholder->backend();
+        if (m_backends.contains(backend) && rows(backend).remove(key(placeholder))) {
+            m_dirty.insert(backend);
+        }
+    }
+
+    // Only check the categories the list was filtered by, rows keep what other lists found
+    QSet<QString> categoryNames;
+    if (filters.category) {
+        collectCategoryNames(filters.category->filter(), categoryNames);
+    }
+
+    // The top of the list is what's shown first, that's the part worth remembering
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    for (const StreamResult &result : results.first(std::min(results.size(), s_maxRows))) {
+        AbstractResource *resource = result.resource;
+        AbstractResourcesBackend *backend = resource->backend();
+        if (resource->isPlaceholder() || !m_backends.contains(backend)) {
+            continue;
+        }
+
+        SnapshotRow row;
+        row.key = key(resource);
+        row.name = resource->name();
+        row.comment = resource->comment();
+        row.icon = iconKey(resource->icon());
+        row.sourceIcon = resource->sourceIcon();
+        row.packageName = resource->packageName();
+        row.appstreamId = resource->appstreamId();
+        row.origin = resource->origin();
+        row.displayOrigin = resource->displayOrigin();
+        row.section = resource->section();
+        row.installedVersion = resource->installedVersion();
+        row.availableVersion = resource->availableVersion();
+        auto &backendRows = rows(backend);
+        row.categories = backendRows.value(row.key).categories;
+        for (const QString &category : std::as_const(categoryNames)) {
+            if (!row.categories.contains(category) && resource->hasCategory(category)) {
+                row.categories += category;
+            }
+        }
+        row.type = resource->type();
+        row.state = resource->state();
+        const Rating rating = resource->rating();
+        row.ratingCount = rating.ratingCount();
+        row.ratingPoints = rating.ratingPoints();
+        row.starCounts = QList<qint32>(rating.starCounts().begin(), rating.starCounts().end());
+        row.releaseDate = resource->releaseDate();
+        row.lastSeen = now;
+
+        backendRows.insert(row.key, row);
+        m_dirty.insert(backend);
+    }
+
+    if (!m_dirty.isEmpty()) {
+        m_saveTimer.start();
+    }
+}
+
+void ResourcesSnapshot::save()
+{
+    m_writes.removeIf([](const QFuture<void> &write) {
+        return write.isFinished();
+    });
+
+    const QString languages = snapshotLanguages();
+    for (AbstractResourcesBackend *backend : std::as_const(m_dirty)) {
+        m_writes += QtConcurrent::run(writeSnapshot, snapshotPath(backend), languages, rows(backend).values());
+    }
+    m_dirty.clear();
+}
+
+#include "ResourcesSnapshot.moc"
+#include "moc_ResourcesSnapshot.cpp"
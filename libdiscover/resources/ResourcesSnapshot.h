@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+// SPDX-FileCopyrightText: 2026 Plasma Discover contributors
+
+#pragma once
+
+#include <QDate>
+#include <QFuture>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+#include "AbstractResourcesBackend.h"
+#include "discovercommon_export.h"
+
+// What a resource list needs to display a resource before its backend has loaded
+struct SnapshotRow {
+    QString key;
+    QString name;
+    QString comment;
+    QString icon;
+    QString sourceIcon;
+    QString packageName;
+    QString appstreamId;
+    QString origin;
+    QString displayOrigin;
+    QString section;
+    QString installedVersion;
+    QString availableVersion;
+    // Names of the Discover categories the resource is in
+    QStringList categories;
+    qint32 type = 0;
+    qint32 state = 0;
+    quint64 ratingCount = 0;
+    qint32 ratingPoints = 0;
+    QList<qint32> starCounts;
+    QDate releaseDate;
+    // When a list last displayed the resource, in seconds since the epoch
+    qint64 lastSeen = 0;
+};
+
+// Persists the rows the browse and installed lists settled on, per backend.
+// On the next start, while a backend is still loading, its lists are filled with
+// placeholders restored from those rows. The lists replace them in place as the
+// live resources arrive and drop the ones that didn't show up.
+class DISCOVERCOMMON_EXPORT ResourcesSnapshot : public QObject
+{
+    Q_OBJECT
+public:
+    static ResourcesSnapshot *global();
+
+    // Starts reading the snapshot of @p backend if it's still loading
+    void addBackend(AbstractResourcesBackend *backend);
+
+    // Placeholders matching @p filters, from the backends that are still loading
+    QVector<StreamResult> resources(const AbstractResourcesBackend::Filters &filters);
+
+    // Remembers the live @p results of @p filters and forgets the @p stale placeholders
+    void record(const AbstractResourcesBackend::Filters &filters, const QVector<StreamResult> &results, const QVector<AbstractResource *> &stale);
+
+    // Identifies a resource and its placeholder across sessions
+    static QString key(AbstractResource *resource);
+
+Q_SIGNALS:
+    // Emitted right before the placeholders of @p backend are deleted
+    void placeholdersRemoved(AbstractResourcesBackend *backend);
+
+private:
+    ResourcesSnapshot();
+    static bool isSnapshotFilter(const AbstractResourcesBackend::Filters &filters);
+    QString snapshotPath(AbstractResourcesBackend *backend) const;
+    QHash<QString, SnapshotRow> &rows(AbstractResourcesBackend *backend);
+    void backendLoaded(AbstractResourcesBackend *backend);
+    void save();
+
+    struct BackendSnapshot {
+        QFuture<QHash<QString, SnapshotRow>> loading;
+        QHash<QString, SnapshotRow> rows;
+        QVector<AbstractResource *> placeholders;
+        bool placeholdersCreated = false;
+        bool backendLoaded = false;
+    };
+    QHash<AbstractResourcesBackend *, BackendSnapshot> m_backends;
+    QSet<AbstractResourcesBackend *> m_dirty;
+    QList<QFuture<void>> m_writes;
+    QTimer m_saveTimer;
+    const QString m_snapshotDir;
+};
@@ -25,6 +25,8 @@
 #include "../libdiscover/UpdateModel/RefreshNotifierDBus.h"
 #include "Login1ManagerInterface.h"
 #include "updatessettings.h"
+#include <UpdatesSnapshot.h>
+#include <algorithm>
 #include <chrono>
 
 #include "debug.h"
@@ -92,8 +94,26 @@ DiscoverNotifier::DiscoverNotifier(const std::chrono::seconds &checkDelay, QObje
     m_timer.setInterval(1s);
     updateStatusNotifier();
 
-    // Only fetch updates after the system is comfortably booted
-    QTimer::singleShot(checkDelay, this, &DiscoverNotifier::recheckSystemUpdateNeeded);
+    // Only fetch updates after the system is comfortably booted. Modules that started off with the
+    // results of a recent check, by Discover or an earlier run, wait until those are stale.
+    QList<BackendNotifierModule *> uncachedModules;
+    for (BackendNotifierModule *module : std::as_const(m_backends)) {
+        const QDateTime checked = module->cachedStateChecked();
+        if (!checked.isValid()) {
+            uncachedModules += module;
+            continue;
+        }
+        const auto age = std::chrono::seconds(checked.secsTo(QDateTime::currentDateTimeUtc()));
+        qCDebug(NOTIFIER) << "Using the cached updates of" << module->metaObject()->className() << "from" << checked;
+        QTimer::singleShot(std::max(checkDelay, UpdatesSnapshot::s_maxAge - age), this, [this, module] {
+            recheckModules({module});
+        });
+    }
+    if (!uncachedModules.isEmpty()) {
+        QTimer::singleShot(checkDelay, this, [this, uncachedModules] {
+            recheckModules(uncachedModules);
+        });
+    }
 
     auto login1 = new OrgFreedesktopLogin1ManagerInterface(QStringLiteral("org.freedesktop.login1"),
                                                            QStringLiteral("/org/freedesktop/login1"),
@@ -284,6 +304,12 @@ void DiscoverNotifier::startUnattendedUpdates()
     connect(process, &QProcess::errorOccurred, this, [](QProcess::ProcessError error) {
         qWarning() << "Error running plasma-discover" << error;
     });
+    // plasma-discover reports its progress as JSON lines
+    connect(process, &QProcess::readyReadStandardOutput, this, [process] {
+        while (process->canReadLine()) {
+            qCDebug(NOTIFIER) << "unattended update:" << process->readLine().trimmed();
+        }
+    });
     connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [this, process](int exitCode, QProcess::ExitStatus exitStatus) {
         qDebug() << "Finished running plasma-discover" << exitCode << exitStatus;
         process->deleteLater();
@@ -376,9 +402,14 @@ QString DiscoverNotifier::message() const
 }
 
 void DiscoverNotifier::recheckSystemUpdateNeeded()
+{
+    recheckModules(m_backends);
+}
+
+void DiscoverNotifier::recheckModules(const QList<BackendNotifierModule *> &modules)
 {
     m_lastUpdate = QDateTime::currentDateTimeUtc();
-    for (BackendNotifierModule *module : std::as_const(m_backends))
+    for (BackendNotifierModule *module : modules)
         module->recheckSystemUpdateNeeded();
 
     QTimer::singleShot(20000, this, &DiscoverNotifier::refreshUnattended);
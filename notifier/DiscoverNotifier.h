@@ -92,6 +92,7 @@ Q_SIGNALS:
     bool busyChanged();
 
 private:
+    void recheckModules(const QList<BackendNotifierModule *> &modules);
     void showRebootNotification();
     void updateStatusNotifier();
     void refreshUnattended();